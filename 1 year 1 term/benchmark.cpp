@@ -0,0 +1,341 @@
+#include "biginteger.h"
+#include "matrix.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<size_t> allocations{0};
+bool countAllocations = false;
+
+} // namespace
+
+void* operator new(size_t size) {
+    if (countAllocations) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+struct Result {
+    std::string name;
+    size_t limbs;
+    size_t iterations;
+    double nsPerOp;
+    double allocationsPerOp;
+};
+
+std::mt19937_64 rng(20240607);
+double minSeconds = 0.2;
+size_t sink = 0;
+
+BigInteger randomNumber(size_t limbs) {
+    std::string digits(std::max<size_t>(limbs * 19, 1), '0');
+    for (char& c : digits) {
+        c = static_cast<char>('0' + rng() % 10);
+    }
+    digits[0] = static_cast<char>('1' + rng() % 9);
+    return BigInteger::fromChars(digits);
+}
+
+BigInteger randomBits(size_t bits) {
+    BigInteger ans = 1;
+    for (size_t left = bits - 1; left > 0;) {
+        size_t take = std::min<size_t>(left, 32);
+        ans = ans * BigInteger(1LL << take) + static_cast<long long>(rng() >> (64 - take));
+        left -= take;
+    }
+    return ans;
+}
+
+BigInteger squareMultiplyPowMod(const BigInteger& a, const BigInteger& e, const BigInteger& m) {
+    auto limbs = e.limbs();
+    BigInteger ans = 1;
+    for (size_t i = limbs.size() * 64; i > 0; --i) {
+        ans *= ans;
+        ans %= m;
+        if ((limbs[(i - 1) / 64] >> ((i - 1) % 64)) & 1) {
+            ans *= a;
+            ans %= m;
+        }
+    }
+    return ans;
+}
+
+template<typename F>
+Result measure(const std::string& name, size_t limbs, F body) {
+    size_t iterations = 1;
+    while (true) {
+        size_t allocated = allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            body();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= minSeconds || iterations >= (size_t(1) << 40)) {
+            allocated = allocations.load(std::memory_order_relaxed) - allocated;
+            return Result{name, limbs, iterations, elapsed.count() * 1e9 / iterations,
+                          static_cast<double>(allocated) / iterations};
+        }
+        iterations *= 2;
+    }
+}
+
+void benchBigInteger(std::vector<Result>& results, size_t limbs) {
+    BigInteger a = randomNumber(limbs);
+    BigInteger b = randomNumber(limbs);
+    BigInteger wide = randomNumber(2 * limbs);
+    std::string text = a.toString();
+    results.push_back(measure("add", limbs, [&] {
+        sink += (a + b).getLength();
+    }));
+    results.push_back(measure("mul", limbs, [&] {
+        sink += (a * b).getLength();
+    }));
+    results.push_back(measure("div", limbs, [&] {
+        sink += (wide / b).getLength();
+    }));
+    results.push_back(measure("mod", limbs, [&] {
+        sink += (wide % b).getLength();
+    }));
+    results.push_back(measure("gcd", limbs, [&] {
+        sink += gcd(a, b).getLength();
+    }));
+    results.push_back(measure("toString", limbs, [&] {
+        sink += a.toString().size();
+    }));
+    results.push_back(measure("parse", limbs, [&] {
+        sink += BigInteger::fromChars(text).getLength();
+    }));
+}
+
+void benchInline(std::vector<Result>& results) {
+    BigInteger c = 0;
+    results.push_back(measure("increment", 1, [&] {
+        ++c;
+    }));
+    BigInteger s = 0;
+    BigInteger x = randomNumber(1);
+    BigInteger k = 12345;
+    BigInteger p = randomNumber(3);
+    results.push_back(measure("mixed_expression", 3, [&] {
+        s = s + x * k - x / 7;
+        s %= p;
+    }));
+    sink += c.getLength() + s.getLength();
+}
+
+void benchExpressions(std::vector<Result>& results) {
+    std::vector<BigInteger> coefficients;
+    std::vector<Rational> rationalCoefficients;
+    for (size_t i = 0; i < 200; ++i) {
+        coefficients.push_back(randomNumber(1));
+        rationalCoefficients.emplace_back(coefficients.back());
+    }
+    BigInteger point = randomNumber(4);
+    Rational rationalPoint(randomNumber(1), randomNumber(1));
+    results.push_back(measure("horner", 4, [&] {
+        BigInteger ans = 0;
+        for (const BigInteger& c : coefficients) {
+            ans = ans * point + c;
+        }
+        sink += ans.getLength();
+    }));
+    results.push_back(measure("rational_horner", 1, [&] {
+        Rational ans = 0;
+        for (const Rational& c : rationalCoefficients) {
+            ans = ans * rationalPoint + c;
+        }
+        sink += ans.getNsize();
+    }));
+    std::vector<BigInteger> factors;
+    for (size_t i = 0; i < 64; ++i) {
+        factors.push_back(randomNumber(4));
+    }
+    results.push_back(measure("repeated_multiply", 4, [&] {
+        BigInteger ans = 1;
+        for (size_t i = 0; i < factors.size(); i += 4) {
+            ans = ans * factors[i] * factors[i + 1] * factors[i + 2] * factors[i + 3];
+        }
+        sink += ans.getLength();
+    }));
+}
+
+void benchRational(std::vector<Result>& results, size_t limbs) {
+    Rational x(randomNumber(limbs), randomNumber(limbs));
+    Rational y(randomNumber(limbs), randomNumber(limbs));
+    results.push_back(measure("rational_add", limbs, [&] {
+        sink += (x + y).getNsize();
+    }));
+    results.push_back(measure("rational_mul", limbs, [&] {
+        sink += (x * y).getNsize();
+    }));
+    results.push_back(measure("rational_div", limbs, [&] {
+        sink += (x / y).getNsize();
+    }));
+    std::vector<Rational> operands;
+    for (size_t i = 0; i < 64; ++i) {
+        operands.emplace_back(randomNumber(limbs), randomNumber(limbs));
+    }
+    size_t i = 0;
+    results.push_back(measure("rational_compare", limbs, [&] {
+        sink += operands[i & 63] < operands[(i + 1) & 63];
+        ++i;
+    }));
+    results.push_back(measure("rational_asDecimal", limbs, [&] {
+        sink += x.asDecimal(100).size();
+    }));
+}
+
+void benchDeterminant(std::vector<Result>& results, const std::string& name, int range) {
+    std::vector<std::vector<int>> entries(50, std::vector<int>(50));
+    for (std::vector<int>& row : entries) {
+        for (int& x : row) {
+            x = static_cast<int>(rng() % (2 * static_cast<uint64_t>(range) + 1)) - range;
+        }
+    }
+    Matrix<50, 50, Rational> matrix(entries);
+    results.push_back(measure(name, 1, [&] {
+        sink += matrix.det().getNsize();
+    }));
+}
+
+void benchPowMod(std::vector<Result>& results, size_t bits) {
+    BigInteger m = randomBits(bits);
+    if (!(m.limbs()[0] & 1)) {
+        m += 1;
+    }
+    BigInteger a = randomBits(bits - 1);
+    BigInteger e = randomBits(bits);
+    BigInteger::MontgomeryContext montgomery(m);
+    BigInteger::BarrettContext barrett(m);
+    size_t limbs = bits / 64;
+    results.push_back(measure("powmod", limbs, [&] {
+        sink += a.powMod(e, m).getLength();
+    }));
+    results.push_back(measure("powmod_montgomery", limbs, [&] {
+        sink += a.powMod(e, montgomery).getLength();
+    }));
+    results.push_back(measure("powmod_barrett", limbs, [&] {
+        sink += a.powMod(e, barrett).getLength();
+    }));
+    results.push_back(measure("powmod_square_multiply", limbs, [&] {
+        sink += squareMultiplyPowMod(a, e, m).getLength();
+    }));
+}
+
+void benchResidue(std::vector<Result>& results) {
+    std::vector<Residue<1000000007>> bases;
+    std::vector<unsigned> exponents;
+    for (size_t i = 0; i < 1024; ++i) {
+        bases.push_back(static_cast<Residue<1000000007>>(static_cast<int>(rng() % 1000000007)));
+        exponents.push_back(static_cast<unsigned>(rng()));
+    }
+    size_t i = 0;
+    results.push_back(measure("residue_pow", 1, [&] {
+        sink += static_cast<int>(bases[i & 1023].pow(exponents[i & 1023]));
+        ++i;
+    }));
+    results.push_back(measure("residue_inverse", 1, [&] {
+        sink += static_cast<int>(bases[i & 1023].getInverse());
+        ++i;
+    }));
+}
+
+bool checkModularMultiply() {
+    BigInteger m = randomNumber(32);
+    if (!(m.limbs()[0] & 1)) {
+        m += 1;
+    }
+    BigInteger a = -randomNumber(80);
+    BigInteger b = randomNumber(70);
+    BigInteger expected = a * b % m;
+    if (expected < 0) {
+        expected += m;
+    }
+    BigInteger::MontgomeryContext montgomery(m);
+    BigInteger::BarrettContext barrett(m);
+    return barrett.multiply(a, b) == expected && montgomery.multiply(montgomery.toMontgomery(a), b) == expected;
+}
+
+void writeJson(std::ostream& out, const std::vector<Result>& results) {
+    out << "{\n  \"threads\": " << BigInteger::getThreadCount() << ",\n  \"rational_lazy_limbs\": "
+        << BIGINTEGER_RATIONAL_LAZY_LIMBS << ",\n  \"checksum\": " << sink
+        << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        out << (i == 0 ? "\n" : ",\n") << "    {\"benchmark\": \"" << results[i].name << "\", \"limbs\": "
+            << results[i].limbs << ", \"iterations\": " << results[i].iterations << ", \"ns_per_op\": "
+            << results[i].nsPerOp;
+        if (countAllocations) {
+            out << ", \"allocations_per_op\": " << results[i].allocationsPerOp;
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t maxLimbs = 1000000;
+    size_t maxRationalLimbs = 10000;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (option == "--count-allocations") {
+            countAllocations = true;
+        } else if (hasValue && option == "--max-limbs") {
+            maxLimbs = std::strtoull(argv[++i], nullptr, 10);
+        } else if (hasValue && option == "--max-rational-limbs") {
+            maxRationalLimbs = std::strtoull(argv[++i], nullptr, 10);
+        } else if (hasValue && option == "--min-time") {
+            minSeconds = std::strtod(argv[++i], nullptr);
+        } else if (hasValue && option == "--threads") {
+            BigInteger::setThreadCount(std::strtoull(argv[++i], nullptr, 10));
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--max-limbs N] [--max-rational-limbs N] [--min-time SECONDS] [--threads N]"
+                         " [--count-allocations]\n";
+            return 1;
+        }
+    }
+    if (!checkModularMultiply()) {
+        std::cerr << "modular multiply check failed\n";
+        return 1;
+    }
+    std::vector<Result> results;
+    for (size_t limbs = 1; limbs <= maxLimbs; limbs *= 10) {
+        benchBigInteger(results, limbs);
+    }
+    benchInline(results);
+    benchExpressions(results);
+    for (size_t limbs = 1; limbs <= std::min(maxLimbs, maxRationalLimbs); limbs *= 10) {
+        benchRational(results, limbs);
+    }
+    benchDeterminant(results, "rational_det_small", 100);
+    benchDeterminant(results, "rational_det_large", 1000000000);
+    benchResidue(results);
+    benchPowMod(results, 2048);
+    benchPowMod(results, 4096);
+    writeJson(std::cout, results);
+    return 0;
+}
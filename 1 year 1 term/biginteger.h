@@ -1,46 +1,429 @@
+#pragma once
+
 #include <iostream>
+#include <algorithm>
 #include <string>
+#include <string_view>
+#include <span>
+#include <bit>
+#include <compare>
+#include <charconv>
 #include <cstring>
+#include <cmath>
+#include <limits>
+#include <cstdint>
 #include <vector>
+#include <deque>
+#include <utility>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <stdexcept>
+#include <condition_variable>
+#include "residue.h"
+
+#if !defined(BIGINTEGER_NO_SIMD) && defined(__x86_64__) && defined(__GNUC__)
+#define BIGINTEGER_SIMD
+#include <immintrin.h>
+#endif
+
+#ifndef BIGINTEGER_KARATSUBA_THRESHOLD
+#define BIGINTEGER_KARATSUBA_THRESHOLD 32
+#endif
+
+#ifndef BIGINTEGER_TOOM3_THRESHOLD
+#define BIGINTEGER_TOOM3_THRESHOLD 200
+#endif
+
+#ifndef BIGINTEGER_TOOM4_THRESHOLD
+#define BIGINTEGER_TOOM4_THRESHOLD 600
+#endif
+
+#ifndef BIGINTEGER_NTT_THRESHOLD
+#define BIGINTEGER_NTT_THRESHOLD 40000
+#endif
+
+#ifndef BIGINTEGER_NEWTON_THRESHOLD
+#define BIGINTEGER_NEWTON_THRESHOLD 3000
+#endif
+
+#ifndef BIGINTEGER_RADIX_THRESHOLD
+#define BIGINTEGER_RADIX_THRESHOLD 30
+#endif
+
+#ifndef BIGINTEGER_HGCD_THRESHOLD
+#define BIGINTEGER_HGCD_THRESHOLD 150
+#endif
+
+#ifndef BIGINTEGER_PARALLEL_THRESHOLD
+#define BIGINTEGER_PARALLEL_THRESHOLD 2000
+#endif
+
+#ifndef BIGINTEGER_LAZY_COLUMN_THRESHOLD
+#define BIGINTEGER_LAZY_COLUMN_THRESHOLD 262144
+#endif
+
+#ifndef BIGINTEGER_RATIONAL_LAZY_LIMBS
+#define BIGINTEGER_RATIONAL_LAZY_LIMBS 0
+#endif
+
+#ifndef BIGINTEGER_INLINE_LIMBS
+#define BIGINTEGER_INLINE_LIMBS 4
+#endif
+
+template<typename Expr>
+class LazyExpr;
 
 class BigInteger {
-    friend std::istream& operator>>(std::istream& in, BigInteger& x);
+    template<typename Expr>
+    friend class LazyExpr;
+    friend BigInteger gcd(const BigInteger& a, const BigInteger& b);
+    friend BigInteger extendedGcd(const BigInteger& a, const BigInteger& b, BigInteger& x, BigInteger& y);
+  public:
+    struct LazyTerm {
+        const BigInteger* a;
+        const BigInteger* b;
+        bool negative;
+    };
+
   private:
-    static const int base = 1'000'000'000;
-    std::vector<int> num;
+    using Limb = uint64_t;
+    using DoubleLimb = unsigned __int128;
+
+    static const int limbBits = 64;
+    static const Limb decimalBase = 10'000'000'000'000'000'000ULL;
+    static const int decimalDigits = 19;
+    static const size_t decimalPowers = 64;
+    static const size_t karatsubaThreshold = BIGINTEGER_KARATSUBA_THRESHOLD;
+    static const size_t toom3Threshold = BIGINTEGER_TOOM3_THRESHOLD;
+    static const size_t toom4Threshold = BIGINTEGER_TOOM4_THRESHOLD;
+    static const size_t nttThreshold = BIGINTEGER_NTT_THRESHOLD;
+    static const size_t newtonThreshold = BIGINTEGER_NEWTON_THRESHOLD;
+    static const size_t radixThreshold = BIGINTEGER_RADIX_THRESHOLD;
+    static const size_t hgcdThreshold = BIGINTEGER_HGCD_THRESHOLD;
+    static const size_t parallelThreshold = BIGINTEGER_PARALLEL_THRESHOLD;
+    static const size_t lazyColumnThreshold = BIGINTEGER_LAZY_COLUMN_THRESHOLD;
+    static const size_t lazyColumnTerms = 8;
+    static const size_t batchLanes = 8;
+
+    static const unsigned nttMod1 = 469'762'049;
+    static const unsigned nttMod2 = 1'811'939'329;
+    static const unsigned nttMod3 = 2'013'265'921;
+    static const size_t nttMaxLength = size_t(1) << 26;
+
+    class LimbVector {
+      private:
+        static const size_t inlineLimbs = BIGINTEGER_INLINE_LIMBS;
+
+        Limb* limbs;
+        size_t length;
+        size_t capacity;
+        Limb small[inlineLimbs];
+
+        bool isInline() const {
+            return limbs == small;
+        }
+
+      public:
+        LimbVector() : limbs(small), length(0), capacity(inlineLimbs) {}
+
+        LimbVector(size_t count, Limb value) : LimbVector() {
+            assign(count, value);
+        }
+
+        LimbVector(const LimbVector& x) : LimbVector() {
+            assign(x.begin(), x.end());
+        }
+
+        LimbVector(LimbVector&& x) noexcept : LimbVector() {
+            *this = std::move(x);
+        }
+
+        ~LimbVector() {
+            if (!isInline()) {
+                delete[] limbs;
+            }
+        }
+
+        LimbVector& operator=(const LimbVector& x) {
+            if (this != &x) {
+                assign(x.begin(), x.end());
+            }
+            return *this;
+        }
+
+        LimbVector& operator=(LimbVector&& x) noexcept {
+            if (this == &x) {
+                return *this;
+            }
+            if (x.isInline()) {
+                std::copy(x.begin(), x.end(), limbs);
+                length = x.length;
+            } else {
+                if (!isInline()) {
+                    delete[] limbs;
+                }
+                limbs = x.limbs;
+                length = x.length;
+                capacity = x.capacity;
+                x.limbs = x.small;
+                x.capacity = inlineLimbs;
+            }
+            x.length = 0;
+            return *this;
+        }
+
+        size_t size() const {
+            return length;
+        }
+
+        Limb* data() {
+            return limbs;
+        }
+
+        const Limb* data() const {
+            return limbs;
+        }
+
+        Limb* begin() {
+            return limbs;
+        }
+
+        const Limb* begin() const {
+            return limbs;
+        }
+
+        Limb* end() {
+            return limbs + length;
+        }
+
+        const Limb* end() const {
+            return limbs + length;
+        }
+
+        Limb& operator[](size_t i) {
+            return limbs[i];
+        }
+
+        const Limb& operator[](size_t i) const {
+            return limbs[i];
+        }
+
+        Limb& back() {
+            return limbs[length - 1];
+        }
+
+        const Limb& back() const {
+            return limbs[length - 1];
+        }
+
+        void reserve(size_t count) {
+            if (count <= capacity) {
+                return;
+            }
+            size_t newCapacity = std::max(count, 2 * capacity);
+            Limb* cur = new Limb[newCapacity];
+            std::copy(begin(), end(), cur);
+            if (!isInline()) {
+                delete[] limbs;
+            }
+            limbs = cur;
+            capacity = newCapacity;
+        }
+
+        void resize(size_t count) {
+            reserve(count);
+            if (count > length) {
+                std::fill(limbs + length, limbs + count, 0);
+            }
+            length = count;
+        }
+
+        void assign(size_t count, Limb value) {
+            length = 0;
+            reserve(count);
+            std::fill(limbs, limbs + count, value);
+            length = count;
+        }
+
+        void assign(const Limb* first, const Limb* last) {
+            length = 0;
+            reserve(last - first);
+            std::copy(first, last, limbs);
+            length = last - first;
+        }
+
+        void push_back(Limb x) {
+            if (length == capacity) {
+                reserve(length + 1);
+            }
+            limbs[length++] = x;
+        }
+
+        void pop_back() {
+            --length;
+        }
+
+        void swap(LimbVector& x) {
+            if (!isInline() && !x.isInline()) {
+                std::swap(limbs, x.limbs);
+                std::swap(length, x.length);
+                std::swap(capacity, x.capacity);
+                return;
+            }
+            LimbVector cur = std::move(x);
+            x = std::move(*this);
+            *this = std::move(cur);
+        }
+    };
+
+    LimbVector num;
     bool isNotNeg;
 
     void normalize() {
         if (num.size() == 0) {
             num.push_back(0);
         }
-        while (num.size() > 1 && num.back() == 0) {
-            num.pop_back();
+        if (num.size() > 1 && num.back() == 0) {
+            num.resize(std::max<size_t>(trimLimbs(num.data(), num.size()), 1));
         }
         if (num.size() == 1 && num[0] == 0) {
             isNotNeg = true;
         }
     }
 
-    static BigInteger stupid_mul(const BigInteger& a, const BigInteger& x);
-
-    static void addNilsToEqualizeSizes(BigInteger& a, BigInteger& b);
-
-    std::pair<BigInteger, BigInteger> split() const;
+    struct LimbKernels {
+        Limb (*add)(Limb* r, const Limb* a, const Limb* b, size_t n);
+        Limb (*sub)(Limb* r, const Limb* a, const Limb* b, size_t n);
+        size_t (*trim)(const Limb* a, size_t n);
+        size_t (*mismatch)(const Limb* a, const Limb* b, size_t n);
+        void (*mulLanes)(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m, Limb* scratch);
+    };
+
+    static const size_t simdLimbs = 8;
+    static const LimbKernels& limbKernels();
+    static Limb addScalar(Limb* r, const Limb* a, const Limb* b, size_t n);
+    static Limb subScalar(Limb* r, const Limb* a, const Limb* b, size_t n);
+    static size_t trimScalar(const Limb* a, size_t n);
+    static size_t mismatchScalar(const Limb* a, const Limb* b, size_t n);
+#ifdef BIGINTEGER_SIMD
+    alignas(32) static constexpr Limb laneBits[16][4] = {
+        {0, 0, 0, 0}, {1, 0, 0, 0}, {0, 1, 0, 0}, {1, 1, 0, 0},
+        {0, 0, 1, 0}, {1, 0, 1, 0}, {0, 1, 1, 0}, {1, 1, 1, 0},
+        {0, 0, 0, 1}, {1, 0, 0, 1}, {0, 1, 0, 1}, {1, 1, 0, 1},
+        {0, 0, 1, 1}, {1, 0, 1, 1}, {0, 1, 1, 1}, {1, 1, 1, 1}
+    };
+
+    static Limb addAvx2(Limb* r, const Limb* a, const Limb* b, size_t n);
+    static Limb subAvx2(Limb* r, const Limb* a, const Limb* b, size_t n);
+    static size_t trimAvx2(const Limb* a, size_t n);
+    static size_t mismatchAvx2(const Limb* a, const Limb* b, size_t n);
+    static Limb addAvx512(Limb* r, const Limb* a, const Limb* b, size_t n);
+    static Limb subAvx512(Limb* r, const Limb* a, const Limb* b, size_t n);
+    static size_t trimAvx512(const Limb* a, size_t n);
+    static size_t mismatchAvx512(const Limb* a, const Limb* b, size_t n);
+    static void splitIfma(Limb* d, const Limb* a, size_t n, size_t digits);
+    static void mulIfma(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m, Limb* scratch);
+#endif
+    static size_t trimLimbs(const Limb* a, size_t n);
+
+    static Limb addLimbs(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m);
+    static Limb subLimbs(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m);
+    static int compareLimbs(const Limb* a, size_t n, const Limb* b, size_t m);
+    int compareMagnitude(const BigInteger& x) const;
+    static Limb mulLimb(Limb* r, const Limb* a, size_t n, Limb c);
+    static Limb subMulLimb(Limb* r, size_t rn, const Limb* a, size_t n, Limb c);
+    static Limb addMulLimb(Limb* r, const Limb* a, size_t n, Limb c);
+    static void negLimbs(Limb* a, size_t n);
+    static void sarLimbs(Limb* a, size_t n, int s);
+    static void divExactLimb(Limb* a, size_t n, Limb d);
+
+    void addSigned(const BigInteger& x, bool xIsNotNeg);
+    void mulSmall(Limb x, Limb add = 0);
+    Limb divSmall(Limb x);
+
+    static void stupid_mul(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m);
+    static void stupid_sqr(Limb* r, const Limb* a, size_t n);
+    static void karatsuba(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m, Limb* scratch);
+    static bool toomEvaluate(Limb* plus, Limb* minus, Limb* tmp, const Limb* a, size_t n,
+                             size_t k, size_t parts, Limb p);
+    static void toomPoint(Limb* wPlus, Limb* wMinus, Limb* scratch, const Limb* a, size_t n,
+                          const Limb* b, size_t m, size_t k, size_t parts, Limb p);
+    static void toomFinish(Limb* r, size_t rn, size_t k, Limb* const* w, size_t count);
+    static void toom3(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m, Limb* scratch);
+    static void toom4(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m, Limb* scratch);
+    template<unsigned Mod>
+    static void ntt(std::vector<Residue<Mod>>& a, bool invert);
+    template<unsigned Mod>
+    static std::vector<uint32_t> nttConvolution(const Limb* a, size_t n, const Limb* b, size_t m, size_t len);
+    static void mulNtt(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m);
+    class TaskPool;
+    class TaskGroup;
+    static TaskPool& taskPool();
+    static void mulLimbs(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m, Limb* scratch);
+    static size_t mulScratchSize(size_t n, size_t m);
+    static void mulBatch(const BigInteger* a, const BigInteger* b, BigInteger* r, const size_t* order, size_t count);
+
+    void shiftLeftLimbs(size_t k);
+    void shiftRightLimbs(size_t k);
+    static BigInteger fromLimbs(const Limb* a, size_t n);
+
+    static const Limb serialVersion = 1;
+    static const Limb serialNegative = 1;
+    static const Limb serialArray = 2;
+    static void storeLimbs(std::byte* out, const Limb* a, size_t n);
+    static void loadLimbs(Limb* r, const std::byte* in, size_t n);
+    static bool readHeader(std::span<const std::byte> in, Limb& tag, size_t& count);
+    static Limb shlLimbs(Limb* r, const Limb* a, size_t n, int s);
+    static void shrLimbs(Limb* r, const Limb* a, size_t n, int s);
+    static void divModLimbs(Limb* q, Limb* u, size_t n, const Limb* v, size_t m);
+    static void divModKnuth(const BigInteger& a, const BigInteger& b, BigInteger& q, BigInteger& r);
+    static BigInteger reciprocal(const BigInteger& b);
+    static void divModBarrett(const BigInteger& a, const BigInteger& b, const BigInteger& inv,
+                              BigInteger& q, BigInteger& r);
+    static void divModNewton(const BigInteger& a, const BigInteger& b, BigInteger& q, BigInteger& r);
+    static void divModAbs(const BigInteger& a, const BigInteger& b, BigInteger& q, BigInteger& r);
+
+    struct GcdMatrix;
+
+    static Limb gcdLimb(Limb a, Limb b);
+    static Limb topBits(const BigInteger& a, size_t shift);
+    static void lehmerCombine(BigInteger& r, const BigInteger& a, const BigInteger& b, long long u, long long v);
+    static void divisionStep(BigInteger& a, BigInteger& b, GcdMatrix* M);
+    static void lehmerStep(BigInteger& a, BigInteger& b, GcdMatrix* M);
+    static void applyInverse(BigInteger& a, BigInteger& b, GcdMatrix& N);
+    static void reduceHigh(BigInteger& a, BigInteger& b, GcdMatrix* M, size_t p);
+    static void halfGcd(BigInteger& a, BigInteger& b, GcdMatrix* M);
+    static void gcdAbs(BigInteger& a, BigInteger& b, GcdMatrix* M);
+
+    static const BigInteger& decimalPower(size_t k);
+    static char* writeDecimal(const BigInteger& x, char* out);
+    static void writeDecimalPadded(const BigInteger& x, size_t k, char* out);
+    static BigInteger parseDecimal(const char* s, size_t len);
+
+    template<size_t K>
+    static Limb addColumns(Limb* r, size_t n, const Limb* const* src, const Limb* mask,
+                           size_t count, Limb carry);
+    static BigInteger evaluateLazy(const LazyTerm* terms, size_t count);
+
+    static BigInteger residue(const BigInteger& x, const BigInteger& mod);
+    template<typename Context>
+    BigInteger powModWith(const BigInteger& e, const Context& ctx) const;
+    template<typename Context>
+    static BigInteger slidingWindowPow(const BigInteger& base, const BigInteger& e, const Context& ctx);
 
   public:
-    BigInteger() : num({0}), isNotNeg(true) {}
+    BigInteger() : num(1, 0), isNotNeg(true) {}
+
+    BigInteger(const BigInteger& x) = default;
+    BigInteger(BigInteger&& x) noexcept = default;
+    BigInteger& operator=(const BigInteger& x) = default;
+    BigInteger& operator=(BigInteger&& x) noexcept = default;
 
     BigInteger(long long x) {
-        isNotNeg = true;
-        if (x < 0) {
-            isNotNeg = false;
-            x = -x;
-        }
-        do {
-            num.push_back(x % base);
-            x /= base;
-        } while (x > 0);
+        isNotNeg = x >= 0;
+        num.push_back(isNotNeg ? static_cast<Limb>(x) : 0 - static_cast<Limb>(x));
     }
 
     void invertSign() {
@@ -54,7 +437,7 @@ class BigInteger {
         return isNotNeg;
     }
 
-    int getLastNumbers() const {
+    Limb getLastNumbers() const {
         return num[0];
     }
 
@@ -62,16 +445,20 @@ class BigInteger {
         return num.size();
     }
 
-    std::vector<int> getNum() const {
-        return num;
+    std::vector<Limb> getNum() const {
+        return std::vector<Limb>(num.begin(), num.end());
+    }
+
+    std::span<const Limb> limbs() const {
+        return std::span<const Limb>(num.data(), num.size());
     }
 
+    int compare(const BigInteger& x) const;
+
     long double toDouble() const {
         long double ans = 0;
-        long double b = 1;
-        for (size_t i = 0; i < num.size(); ++i) {
-            ans += num[i] * b;
-            b *= base;
+        for (size_t i = num.size(); i > 0; --i) {
+            ans = ans * 18446744073709551616.0L + num[i - 1];
         }
         if (!isNotNeg) {
             ans = -ans;
@@ -79,23 +466,26 @@ class BigInteger {
         return ans;
     }
 
+    long double toDouble(long long& exponent) const;
+    size_t bitLength() const;
+
+    size_t maxChars() const;
+    std::to_chars_result toChars(char* first, char* last) const;
+    static std::from_chars_result fromChars(const char* first, const char* last, BigInteger& value);
+    static BigInteger fromChars(std::string_view str);
+    static BigInteger powerOfTen(size_t k);
+
+    size_t serializedSize() const;
+    std::byte* serialize(std::span<std::byte> out) const;
+    static const std::byte* deserialize(std::span<const std::byte> in, BigInteger& x);
+    static std::span<const Limb> viewSerialized(std::span<const std::byte> in, bool& isNotNeg);
+    static size_t serializedSize(std::span<const BigInteger> values);
+    static std::byte* serializeMany(std::span<const BigInteger> values, std::span<std::byte> out);
+    static const std::byte* deserializeMany(std::span<const std::byte> in, std::vector<BigInteger>& values);
+
     std::string toString() const {
-        std::string cur = "";
-        if (!isNotNeg) {
-            cur = "-";
-        }
-        if (num.size() != 0) {
-            cur += std::to_string(num.back());
-        }
-        for (int i = static_cast<int>(num.size()) - 2; i >= 0; --i) {
-            int a = base;
-            int b = num[i];
-            for (int j = 0; j < 9; ++j) {
-                a /= 10;
-                cur += '0' + b / a;
-                b %= a;
-            }
-        }
+        std::string cur(maxChars(), '\0');
+        cur.resize(toChars(cur.data(), cur.data() + cur.size()).ptr - cur.data());
         return cur;
     }
 
@@ -116,6 +506,23 @@ class BigInteger {
     BigInteger& operator/=(const BigInteger& x);
     BigInteger& operator%=(const BigInteger& x);
 
+    std::pair<BigInteger, BigInteger> divmod(const BigInteger& x) const;
+    void divmod(const BigInteger& x, BigInteger& quotient, BigInteger& remainder) const;
+    BigInteger& divAssign(const BigInteger& x, BigInteger& remainder);
+    BigInteger& modAssign(const BigInteger& x, BigInteger& quotient);
+
+    class MontgomeryContext;
+    class BarrettContext;
+
+    BigInteger powMod(const BigInteger& e, const BigInteger& m) const;
+    BigInteger powMod(const BigInteger& e, const MontgomeryContext& ctx) const;
+    BigInteger powMod(const BigInteger& e, const BarrettContext& ctx) const;
+
+    static void mulMany(std::span<const BigInteger> a, std::span<const BigInteger> b, std::span<BigInteger> r);
+
+    static void setThreadCount(size_t count);
+    static size_t getThreadCount();
+
 
     BigInteger& operator++() {
         *this += 1;
@@ -138,442 +545,2810 @@ class BigInteger {
         --*this;
         return cur;
     }
-};
+};
+
+
+bool operator==(const BigInteger& a, const BigInteger& x) {
+    return a.compare(x) == 0;
+}
+
+bool operator!=(const BigInteger& a, const BigInteger& x) {
+    return !(a == x);
+}
+
+bool operator<(const BigInteger& a, const BigInteger& x) {
+    return a.compare(x) < 0;
+}
+
+bool operator<=(const BigInteger& a, const BigInteger& x) {
+    return !(x < a);
+}
+
+bool operator>(const BigInteger& a, const BigInteger& x) {
+    return x < a;
+}
+
+bool operator>=(const BigInteger& a, const BigInteger& x) {
+    return !(a < x);
+}
+
+std::strong_ordering operator<=>(const BigInteger& a, const BigInteger& x) {
+    return a.compare(x) <=> 0;
+}
+
+BigInteger::operator bool() const {
+    return num.size() > 1 || num[0] != 0;
+}
+
+BigInteger::Limb BigInteger::addScalar(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    Limb carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        DoubleLimb cur = static_cast<DoubleLimb>(a[i]) + b[i] + carry;
+        r[i] = static_cast<Limb>(cur);
+        carry = static_cast<Limb>(cur >> limbBits);
+    }
+    return carry;
+}
+
+BigInteger::Limb BigInteger::subScalar(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    Limb borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        DoubleLimb cur = static_cast<DoubleLimb>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<Limb>(cur);
+        borrow = static_cast<Limb>(cur >> limbBits) & 1;
+    }
+    return borrow;
+}
+
+size_t BigInteger::trimScalar(const Limb* a, size_t n) {
+    while (n > 0 && a[n - 1] == 0) {
+        --n;
+    }
+    return n;
+}
+
+size_t BigInteger::mismatchScalar(const Limb* a, const Limb* b, size_t n) {
+    while (n > 0 && a[n - 1] == b[n - 1]) {
+        --n;
+    }
+    return n;
+}
+
+#ifdef BIGINTEGER_SIMD
+__attribute__((target("avx2")))
+BigInteger::Limb BigInteger::addAvx2(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    unsigned carry = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i sum = _mm256_add_epi64(x, y);
+        __m256i overflow = _mm256_cmpgt_epi64(_mm256_xor_si256(x, sign), _mm256_xor_si256(sum, sign));
+        unsigned generate = _mm256_movemask_pd(_mm256_castsi256_pd(overflow));
+        unsigned propagate = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(sum, ones)));
+        unsigned carries = (((generate << 1) | carry) + propagate) ^ propagate;
+        carry = (carries >> 4) & 1;
+        sum = _mm256_add_epi64(sum, _mm256_load_si256(reinterpret_cast<const __m256i*>(laneBits[carries & 15])));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), sum);
+    }
+    for (; i < n; ++i) {
+        DoubleLimb cur = static_cast<DoubleLimb>(a[i]) + b[i] + carry;
+        r[i] = static_cast<Limb>(cur);
+        carry = static_cast<unsigned>(cur >> limbBits);
+    }
+    return carry;
+}
+
+__attribute__((target("avx2")))
+BigInteger::Limb BigInteger::subAvx2(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i zero = _mm256_setzero_si256();
+    unsigned borrow = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i diff = _mm256_sub_epi64(x, y);
+        __m256i underflow = _mm256_cmpgt_epi64(_mm256_xor_si256(y, sign), _mm256_xor_si256(x, sign));
+        unsigned generate = _mm256_movemask_pd(_mm256_castsi256_pd(underflow));
+        unsigned propagate = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(diff, zero)));
+        unsigned borrows = (((generate << 1) | borrow) + propagate) ^ propagate;
+        borrow = (borrows >> 4) & 1;
+        diff = _mm256_sub_epi64(diff, _mm256_load_si256(reinterpret_cast<const __m256i*>(laneBits[borrows & 15])));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), diff);
+    }
+    for (; i < n; ++i) {
+        DoubleLimb cur = static_cast<DoubleLimb>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<Limb>(cur);
+        borrow = static_cast<unsigned>(cur >> limbBits) & 1;
+    }
+    return borrow;
+}
+
+__attribute__((target("avx2")))
+size_t BigInteger::trimAvx2(const Limb* a, size_t n) {
+    while (n >= 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + n - 4));
+        if (!_mm256_testz_si256(x, x)) {
+            break;
+        }
+        n -= 4;
+    }
+    return trimScalar(a, n);
+}
+
+__attribute__((target("avx2")))
+size_t BigInteger::mismatchAvx2(const Limb* a, const Limb* b, size_t n) {
+    while (n >= 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + n - 4));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + n - 4));
+        unsigned equal = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, y)));
+        if (equal != 15) {
+            return n - 3 + (31 - __builtin_clz(~equal & 15));
+        }
+        n -= 4;
+    }
+    return mismatchScalar(a, b, n);
+}
+
+__attribute__((target("avx512f")))
+BigInteger::Limb BigInteger::addAvx512(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    const __m512i one = _mm512_set1_epi64(1);
+    const __m512i ones = _mm512_set1_epi64(-1);
+    unsigned carry = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i sum = _mm512_add_epi64(x, _mm512_loadu_si512(b + i));
+        unsigned generate = _mm512_cmplt_epu64_mask(sum, x);
+        unsigned propagate = _mm512_cmpeq_epi64_mask(sum, ones);
+        unsigned carries = (((generate << 1) | carry) + propagate) ^ propagate;
+        carry = (carries >> 8) & 1;
+        sum = _mm512_mask_add_epi64(sum, static_cast<__mmask8>(carries), sum, one);
+        _mm512_storeu_si512(r + i, sum);
+    }
+    for (; i < n; ++i) {
+        DoubleLimb cur = static_cast<DoubleLimb>(a[i]) + b[i] + carry;
+        r[i] = static_cast<Limb>(cur);
+        carry = static_cast<unsigned>(cur >> limbBits);
+    }
+    return carry;
+}
+
+__attribute__((target("avx512f")))
+BigInteger::Limb BigInteger::subAvx512(Limb* r, const Limb* a, const Limb* b, size_t n) {
+    const __m512i one = _mm512_set1_epi64(1);
+    const __m512i zero = _mm512_setzero_si512();
+    unsigned borrow = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + i);
+        __m512i diff = _mm512_sub_epi64(x, y);
+        unsigned generate = _mm512_cmplt_epu64_mask(x, y);
+        unsigned propagate = _mm512_cmpeq_epi64_mask(diff, zero);
+        unsigned borrows = (((generate << 1) | borrow) + propagate) ^ propagate;
+        borrow = (borrows >> 8) & 1;
+        diff = _mm512_mask_sub_epi64(diff, static_cast<__mmask8>(borrows), diff, one);
+        _mm512_storeu_si512(r + i, diff);
+    }
+    for (; i < n; ++i) {
+        DoubleLimb cur = static_cast<DoubleLimb>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<Limb>(cur);
+        borrow = static_cast<unsigned>(cur >> limbBits) & 1;
+    }
+    return borrow;
+}
+
+__attribute__((target("avx512f")))
+size_t BigInteger::trimAvx512(const Limb* a, size_t n) {
+    while (n >= 8) {
+        __m512i x = _mm512_loadu_si512(a + n - 8);
+        if (_mm512_test_epi64_mask(x, x) != 0) {
+            break;
+        }
+        n -= 8;
+    }
+    return trimScalar(a, n);
+}
+
+__attribute__((target("avx512f")))
+size_t BigInteger::mismatchAvx512(const Limb* a, const Limb* b, size_t n) {
+    while (n >= 8) {
+        __m512i x = _mm512_loadu_si512(a + n - 8);
+        __m512i y = _mm512_loadu_si512(b + n - 8);
+        unsigned different = _mm512_cmpneq_epi64_mask(x, y);
+        if (different != 0) {
+            return n - 7 + (31 - __builtin_clz(different));
+        }
+        n -= 8;
+    }
+    return mismatchScalar(a, b, n);
+}
+
+__attribute__((target("avx512f,avx512ifma")))
+void BigInteger::splitIfma(Limb* d, const Limb* a, size_t n, size_t digits) {
+    const __m512i mask = _mm512_set1_epi64((Limb(1) << 52) - 1);
+    for (size_t k = 0; k < digits; ++k) {
+        size_t q = k * 52 / limbBits;
+        unsigned s = k * 52 % limbBits;
+        __m512i x = _mm512_maskz_srli_epi64(0xFF, _mm512_loadu_si512(a + q * batchLanes), s);
+        if (s > limbBits - 52 && q + 1 < n) {
+            __m512i y = _mm512_loadu_si512(a + (q + 1) * batchLanes);
+            x = _mm512_or_si512(x, _mm512_maskz_slli_epi64(0xFF, y, limbBits - s));
+        }
+        _mm512_storeu_si512(d + k * batchLanes, _mm512_and_si512(x, mask));
+    }
+}
+
+__attribute__((target("avx512f,avx512ifma")))
+void BigInteger::mulIfma(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m, Limb* scratch) {
+    size_t nd = (n * limbBits + 51) / 52;
+    size_t md = (m * limbBits + 51) / 52;
+    Limb* da = scratch;
+    Limb* db = da + nd * batchLanes;
+    Limb* acc = db + md * batchLanes;
+    splitIfma(da, a, n, nd);
+    splitIfma(db, b, m, md);
+    std::fill(acc, acc + (nd + md) * batchLanes, 0);
+    const __m512i zero = _mm512_setzero_si512();
+    for (size_t i = 0; i < md; ++i) {
+        __m512i y = _mm512_loadu_si512(db + i * batchLanes);
+        __m512i hi = zero;
+        for (size_t j = 0; j < nd; ++j) {
+            __m512i x = _mm512_loadu_si512(da + j * batchLanes);
+            Limb* cur = acc + (i + j) * batchLanes;
+            __m512i sum = _mm512_add_epi64(_mm512_loadu_si512(cur), hi);
+            _mm512_storeu_si512(cur, _mm512_madd52lo_epu64(sum, x, y));
+            hi = _mm512_madd52hi_epu64(zero, x, y);
+        }
+        Limb* cur = acc + (i + nd) * batchLanes;
+        _mm512_storeu_si512(cur, _mm512_add_epi64(_mm512_loadu_si512(cur), hi));
+    }
+    for (size_t l = 0; l < batchLanes; ++l) {
+        DoubleLimb cur = 0;
+        size_t bits = 0;
+        size_t out = 0;
+        for (size_t k = 0; k < nd + md; ++k) {
+            cur += static_cast<DoubleLimb>(acc[k * batchLanes + l]) << bits;
+            bits += 52;
+            if (bits >= limbBits && out < n + m) {
+                r[out++ * batchLanes + l] = static_cast<Limb>(cur);
+                cur >>= limbBits;
+                bits -= limbBits;
+            }
+        }
+        for (; out < n + m; ++out) {
+            r[out * batchLanes + l] = static_cast<Limb>(cur);
+            cur >>= limbBits;
+        }
+    }
+}
+#endif
+
+const BigInteger::LimbKernels& BigInteger::limbKernels() {
+    static const LimbKernels kernels = [] {
+#ifdef BIGINTEGER_SIMD
+        if (__builtin_cpu_supports("avx512f")) {
+            return LimbKernels{addAvx512, subAvx512, trimAvx512, mismatchAvx512,
+                               __builtin_cpu_supports("avx512ifma") ? mulIfma : nullptr};
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return LimbKernels{addAvx2, subAvx2, trimAvx2, mismatchAvx2, nullptr};
+        }
+#endif
+        return LimbKernels{addScalar, subScalar, trimScalar, mismatchScalar, nullptr};
+    }();
+    return kernels;
+}
+
+size_t BigInteger::trimLimbs(const Limb* a, size_t n) {
+    if (n >= simdLimbs && a[n - 1] == 0) {
+        return limbKernels().trim(a, n);
+    }
+    return trimScalar(a, n);
+}
+
+BigInteger::Limb BigInteger::addLimbs(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m) {
+    Limb carry = m >= simdLimbs ? limbKernels().add(r, a, b, m) : addScalar(r, a, b, m);
+    size_t i = m;
+    for (; i < n && carry; ++i) {
+        r[i] = a[i] + 1;
+        carry = (r[i] == 0);
+    }
+    if (r != a) {
+        std::copy(a + i, a + n, r + i);
+    }
+    return carry;
+}
+
+BigInteger::Limb BigInteger::subLimbs(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m) {
+    Limb borrow = m >= simdLimbs ? limbKernels().sub(r, a, b, m) : subScalar(r, a, b, m);
+    size_t i = m;
+    for (; i < n && borrow; ++i) {
+        borrow = (a[i] == 0);
+        r[i] = a[i] - 1;
+    }
+    if (r != a) {
+        std::copy(a + i, a + n, r + i);
+    }
+    return borrow;
+}
+
+int BigInteger::compareLimbs(const Limb* a, size_t n, const Limb* b, size_t m) {
+    while (n > 0 && a[n - 1] == 0) {
+        --n;
+    }
+    while (m > 0 && b[m - 1] == 0) {
+        --m;
+    }
+    if (n != m) {
+        return n < m ? -1 : 1;
+    }
+    if (n >= simdLimbs) {
+        n = limbKernels().mismatch(a, b, n);
+        return n == 0 ? 0 : (a[n - 1] < b[n - 1] ? -1 : 1);
+    }
+    for (size_t i = n; i > 0; --i) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+int BigInteger::compareMagnitude(const BigInteger& x) const {
+    return compareLimbs(num.data(), num.size(), x.num.data(), x.num.size());
+}
+
+int BigInteger::compare(const BigInteger& x) const {
+    if (isNotNeg != x.isNotNeg) {
+        return isNotNeg ? 1 : -1;
+    }
+    int ans = compareMagnitude(x);
+    return isNotNeg ? ans : -ans;
+}
+
+size_t BigInteger::bitLength() const {
+    return num.size() * limbBits - __builtin_clzll(num.back() | 1) - (num.back() == 0);
+}
+
+long double BigInteger::toDouble(long long& exponent) const {
+    exponent = static_cast<long long>(bitLength());
+    Limb top = num[0];
+    int scale = static_cast<int>(exponent);
+    if (exponent > limbBits) {
+        size_t shift = exponent - limbBits;
+        size_t i = shift / limbBits;
+        int s = shift % limbBits;
+        top = num[i] >> s;
+        if (s != 0) {
+            top |= num[i + 1] << (limbBits - s);
+        }
+        scale = limbBits;
+    }
+    long double ans = std::ldexp(static_cast<long double>(top), -scale);
+    return isNotNeg ? ans : -ans;
+}
+
+BigInteger::Limb BigInteger::mulLimb(Limb* r, const Limb* a, size_t n, Limb c) {
+    Limb carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        DoubleLimb cur = static_cast<DoubleLimb>(a[i]) * c + carry;
+        r[i] = static_cast<Limb>(cur);
+        carry = static_cast<Limb>(cur >> limbBits);
+    }
+    return carry;
+}
+
+BigInteger::Limb BigInteger::subMulLimb(Limb* r, size_t rn, const Limb* a, size_t n, Limb c) {
+    Limb carry = 0;
+    size_t i = 0;
+    for (; i < n; ++i) {
+        DoubleLimb cur = static_cast<DoubleLimb>(a[i]) * c + carry;
+        Limb low = static_cast<Limb>(cur);
+        carry = static_cast<Limb>(cur >> limbBits) + (r[i] < low);
+        r[i] -= low;
+    }
+    for (; i < rn && carry; ++i) {
+        Limb low = carry;
+        carry = (r[i] < low);
+        r[i] -= low;
+    }
+    return carry;
+}
+
+BigInteger::Limb BigInteger::addMulLimb(Limb* r, const Limb* a, size_t n, Limb c) {
+    Limb carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        DoubleLimb cur = static_cast<DoubleLimb>(a[i]) * c + r[i] + carry;
+        r[i] = static_cast<Limb>(cur);
+        carry = static_cast<Limb>(cur >> limbBits);
+    }
+    return carry;
+}
+
+void BigInteger::sarLimbs(Limb* a, size_t n, int s) {
+    for (size_t i = 0; i + 1 < n; ++i) {
+        a[i] = (a[i] >> s) | (a[i + 1] << (limbBits - s));
+    }
+    a[n - 1] = static_cast<Limb>(static_cast<int64_t>(a[n - 1]) >> s);
+}
+
+void BigInteger::divExactLimb(Limb* a, size_t n, Limb d) {
+    Limb inv = d;
+    for (int i = 0; i < 5; ++i) {
+        inv *= 2 - d * inv;
+    }
+    Limb carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        Limb borrow = (a[i] < carry);
+        a[i] = (a[i] - carry) * inv;
+        carry = static_cast<Limb>((static_cast<DoubleLimb>(a[i]) * d) >> limbBits) + borrow;
+    }
+}
+
+void BigInteger::addSigned(const BigInteger& x, bool xIsNotNeg) {
+    size_t n = num.size();
+    size_t m = x.num.size();
+    if (isNotNeg == xIsNotNeg) {
+        num.resize(std::max(n, m) + 1);
+        if (n >= m) {
+            num[n] = addLimbs(num.data(), num.data(), n, x.num.data(), m);
+        } else {
+            num[m] = addLimbs(num.data(), x.num.data(), m, num.data(), n);
+        }
+    } else if (compareMagnitude(x) >= 0) {
+        subLimbs(num.data(), num.data(), n, x.num.data(), m);
+    } else {
+        num.resize(m);
+        subLimbs(num.data(), x.num.data(), m, num.data(), m);
+        isNotNeg = xIsNotNeg;
+    }
+    normalize();
+}
+
+void BigInteger::mulSmall(Limb x, Limb add) {
+    Limb carry = add;
+    for (size_t i = 0; i < num.size(); ++i) {
+        DoubleLimb cur = static_cast<DoubleLimb>(num[i]) * x + carry;
+        num[i] = static_cast<Limb>(cur);
+        carry = static_cast<Limb>(cur >> limbBits);
+    }
+    if (carry) {
+        num.push_back(carry);
+    }
+    normalize();
+}
+
+BigInteger::Limb BigInteger::divSmall(Limb x) {
+    Limb rem = 0;
+    for (size_t i = num.size(); i > 0; --i) {
+        DoubleLimb cur = (static_cast<DoubleLimb>(rem) << limbBits) | num[i - 1];
+        num[i - 1] = static_cast<Limb>(cur / x);
+        rem = static_cast<Limb>(cur % x);
+    }
+    normalize();
+    return rem;
+}
+
+BigInteger& BigInteger::operator+=(const BigInteger& x) {
+    addSigned(x, x.isNotNeg);
+    return *this;
+}
+
+BigInteger& BigInteger::operator-=(const BigInteger& x) {
+    addSigned(x, !x.isNotNeg);
+    return *this;
+}
+
+class BigInteger::TaskPool {
+  private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::mutex resizing;
+    std::atomic<size_t> threads{1};
+    bool stopping = false;
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] {
+                return stopping || !tasks.empty();
+            });
+            if (tasks.empty()) {
+                return;
+            }
+            std::function<void()> task = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+  public:
+    ~TaskPool() {
+        resize(1);
+    }
+
+    size_t size() const {
+        return threads.load(std::memory_order_relaxed);
+    }
+
+    void resize(size_t count) {
+        std::lock_guard<std::mutex> guard(resizing);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+        stopping = false;
+        for (size_t i = 1; i < count; ++i) {
+            workers.emplace_back([this] {
+                work();
+            });
+        }
+        threads.store(count, std::memory_order_relaxed);
+    }
+
+    void push(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    bool runOne() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (tasks.empty()) {
+            return false;
+        }
+        std::function<void()> task = std::move(tasks.front());
+        tasks.pop_front();
+        lock.unlock();
+        task();
+        return true;
+    }
+};
+
+class BigInteger::TaskGroup {
+  private:
+    bool parallel;
+    size_t pending = 0;
+    std::mutex mutex;
+    std::condition_variable done;
+    std::vector<std::vector<Limb>> buffers;
+
+  public:
+    explicit TaskGroup(size_t size) : parallel(size >= parallelThreshold && taskPool().size() > 1) {}
+
+    ~TaskGroup() {
+        wait();
+    }
+
+    template<typename F>
+    void run(Limb* scratch, size_t scratchSize, F task) {
+        if (!parallel) {
+            task(scratch);
+            return;
+        }
+        buffers.emplace_back(scratchSize);
+        Limb* own = buffers.back().data();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++pending;
+        }
+        taskPool().push([this, own, task] {
+            task(own);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                done.notify_all();
+            }
+        });
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (pending > 0) {
+            lock.unlock();
+            bool ran = taskPool().runOne();
+            lock.lock();
+            if (!ran) {
+                done.wait(lock, [this] {
+                    return pending == 0;
+                });
+            }
+        }
+    }
+};
+
+BigInteger::TaskPool& BigInteger::taskPool() {
+    static TaskPool pool;
+    return pool;
+}
+
+void BigInteger::setThreadCount(size_t count) {
+    taskPool().resize(std::max<size_t>(count, 1));
+}
+
+size_t BigInteger::getThreadCount() {
+    return taskPool().size();
+}
+
+void BigInteger::stupid_mul(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m) {
+    std::fill(r, r + n + m, 0);
+    for (size_t i = 0; i < m; ++i) {
+        if (b[i] == 0) {
+            continue;
+        }
+        Limb nxt = 0;
+        for (size_t j = 0; j < n; ++j) {
+            DoubleLimb cur = static_cast<DoubleLimb>(b[i]) * a[j] + nxt + r[i + j];
+            r[i + j] = static_cast<Limb>(cur);
+            nxt = static_cast<Limb>(cur >> limbBits);
+        }
+        r[i + n] = nxt;
+    }
+}
+
+void BigInteger::stupid_sqr(Limb* r, const Limb* a, size_t n) {
+    std::fill(r, r + 2 * n, 0);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        r[i + n] = addMulLimb(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    }
+    shlLimbs(r, r, 2 * n, 1);
+    Limb carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        DoubleLimb sq = static_cast<DoubleLimb>(a[i]) * a[i];
+        DoubleLimb low = static_cast<DoubleLimb>(r[2 * i]) + static_cast<Limb>(sq) + carry;
+        r[2 * i] = static_cast<Limb>(low);
+        DoubleLimb high = static_cast<DoubleLimb>(r[2 * i + 1]) + static_cast<Limb>(sq >> limbBits) +
+                          static_cast<Limb>(low >> limbBits);
+        r[2 * i + 1] = static_cast<Limb>(high);
+        carry = static_cast<Limb>(high >> limbBits);
+    }
+}
+
+void BigInteger::karatsuba(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m, Limb* scratch) {
+    size_t k = (n + 1) / 2;
+    TaskGroup group(m);
+    group.run(scratch, mulScratchSize(k, k), [=](Limb* s) {
+        mulLimbs(r, a, k, b, k, s);
+    });
+    group.run(scratch, mulScratchSize(k, k), [=](Limb* s) {
+        mulLimbs(r + 2 * k, a + k, n - k, b + k, m - k, s);
+    });
+
+    Limb* sa = scratch;
+    Limb* sb = sa + k + 1;
+    Limb* z1 = sb + k + 1;
+    sa[k] = addLimbs(sa, a, k, a + k, n - k);
+    if (a == b && n == m) {
+        mulLimbs(z1, sa, k + 1, sa, k + 1, z1 + 2 * k + 2);
+    } else {
+        sb[k] = addLimbs(sb, b, k, b + k, m - k);
+        mulLimbs(z1, sa, k + 1, sb, k + 1, z1 + 2 * k + 2);
+    }
+    group.wait();
+    subLimbs(z1, z1, 2 * k + 2, r, 2 * k);
+    subLimbs(z1, z1, 2 * k + 2, r + 2 * k, n + m - 2 * k);
+    addLimbs(r + k, r + k, n + m - k, z1, std::min(2 * k + 2, n + m - k));
+}
+
+bool BigInteger::toomEvaluate(Limb* plus, Limb* minus, Limb* tmp, const Limb* a, size_t n,
+                              size_t k, size_t parts, Limb p) {
+    std::fill(tmp, tmp + k + 1, 0);
+    std::fill(minus, minus + k + 1, 0);
+    for (size_t i = parts; i > 0; --i) {
+        Limb* acc = (i % 2 == 1) ? tmp : minus;
+        size_t from = (i - 1) * k;
+        mulLimb(acc, acc, k + 1, p * p);
+        addLimbs(acc, acc, k + 1, a + from, std::min(k, n - from));
+    }
+    mulLimb(minus, minus, k + 1, p);
+    addLimbs(plus, tmp, k + 1, minus, k + 1);
+    if (compareLimbs(tmp, k + 1, minus, k + 1) >= 0) {
+        subLimbs(minus, tmp, k + 1, minus, k + 1);
+        return false;
+    }
+    subLimbs(minus, minus, k + 1, tmp, k + 1);
+    return true;
+}
+
+void BigInteger::negLimbs(Limb* a, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = ~a[i];
+    }
+    for (size_t i = 0; i < n && ++a[i] == 0; ++i) {
+    }
+}
+
+void BigInteger::toomPoint(Limb* wPlus, Limb* wMinus, Limb* scratch, const Limb* a, size_t n,
+                           const Limb* b, size_t m, size_t k, size_t parts, Limb p) {
+    size_t width = 2 * k + 3;
+    Limb* aPlus = scratch;
+    Limb* aMinus = aPlus + k + 1;
+    Limb* bPlus = aMinus + k + 1;
+    Limb* bMinus = bPlus + k + 1;
+    Limb* tmp = bMinus + k + 1;
+    bool negative = toomEvaluate(aPlus, aMinus, tmp, a, n, k, parts, p);
+    negative ^= toomEvaluate(bPlus, bMinus, tmp, b, m, k, parts, p);
+    mulLimbs(wPlus, aPlus, k + 1, bPlus, k + 1, tmp);
+    wPlus[width - 1] = 0;
+    if (wMinus != nullptr) {
+        mulLimbs(wMinus, aMinus, k + 1, bMinus, k + 1, tmp);
+        wMinus[width - 1] = 0;
+        if (negative) {
+            negLimbs(wMinus, width);
+        }
+    }
+}
+
+void BigInteger::toomFinish(Limb* r, size_t rn, size_t k, Limb* const* w, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        size_t from = (i + 1) * k;
+        addLimbs(r + from, r + from, rn - from, w[i], std::min(2 * k + 3, rn - from));
+    }
+}
+
+void BigInteger::toom3(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m, Limb* scratch) {
+    size_t k = (n + 2) / 3;
+    size_t width = 2 * k + 3;
+    size_t rn = n + m;
+    size_t pointScratch = 5 * (k + 1) + mulScratchSize(k + 1, k + 1);
+    TaskGroup group(m);
+    group.run(scratch, mulScratchSize(k, k), [=](Limb* s) {
+        mulLimbs(r, a, k, b, k, s);
+    });
+    group.run(scratch, mulScratchSize(k, k), [=](Limb* s) {
+        mulLimbs(r + 4 * k, a + 2 * k, n - 2 * k, b + 2 * k, m - 2 * k, s);
+    });
+    std::fill(r + 2 * k, r + 4 * k, 0);
+    const Limb* c0 = r;
+    const Limb* c4 = r + 4 * k;
+    size_t c4n = rn - 4 * k;
+
+    Limb* w1 = scratch;
+    Limb* wm1 = w1 + width;
+    Limb* w2 = wm1 + width;
+    Limb* rest = w2 + width;
+    group.run(rest, pointScratch, [=](Limb* s) {
+        toomPoint(w1, wm1, s, a, n, b, m, k, 3, 1);
+    });
+    group.run(rest, pointScratch, [=](Limb* s) {
+        toomPoint(w2, nullptr, s, a, n, b, m, k, 3, 2);
+    });
+    group.wait();
+
+    subLimbs(wm1, w1, width, wm1, width);
+    sarLimbs(wm1, width, 1);
+    subLimbs(w1, w1, width, wm1, width);
+    subLimbs(w1, w1, width, c0, 2 * k);
+    subLimbs(w1, w1, width, c4, c4n);
+    subLimbs(w2, w2, width, c0, 2 * k);
+    subMulLimb(w2, width, w1, width, 4);
+    subMulLimb(w2, width, c4, c4n, 16);
+    sarLimbs(w2, width, 1);
+    subLimbs(w2, w2, width, wm1, width);
+    divExactLimb(w2, width, 3);
+    subLimbs(wm1, wm1, width, w2, width);
+
+    Limb* w[3] = {wm1, w1, w2};
+    toomFinish(r, rn, k, w, 3);
+}
+
+void BigInteger::toom4(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m, Limb* scratch) {
+    size_t k = (n + 3) / 4;
+    size_t width = 2 * k + 3;
+    size_t rn = n + m;
+    size_t pointScratch = 5 * (k + 1) + mulScratchSize(k + 1, k + 1);
+    TaskGroup group(m);
+    group.run(scratch, mulScratchSize(k, k), [=](Limb* s) {
+        mulLimbs(r, a, k, b, k, s);
+    });
+    group.run(scratch, mulScratchSize(k, k), [=](Limb* s) {
+        mulLimbs(r + 6 * k, a + 3 * k, n - 3 * k, b + 3 * k, m - 3 * k, s);
+    });
+    std::fill(r + 2 * k, r + 6 * k, 0);
+    const Limb* c0 = r;
+    const Limb* c6 = r + 6 * k;
+    size_t c6n = rn - 6 * k;
+
+    Limb* w1 = scratch;
+    Limb* wm1 = w1 + width;
+    Limb* w2 = wm1 + width;
+    Limb* wm2 = w2 + width;
+    Limb* w3 = wm2 + width;
+    Limb* rest = w3 + width;
+    group.run(rest, pointScratch, [=](Limb* s) {
+        toomPoint(w1, wm1, s, a, n, b, m, k, 4, 1);
+    });
+    group.run(rest, pointScratch, [=](Limb* s) {
+        toomPoint(w2, wm2, s, a, n, b, m, k, 4, 2);
+    });
+    group.run(rest, pointScratch, [=](Limb* s) {
+        toomPoint(w3, nullptr, s, a, n, b, m, k, 4, 3);
+    });
+    group.wait();
+
+    subLimbs(wm1, w1, width, wm1, width);
+    sarLimbs(wm1, width, 1);
+    subLimbs(w1, w1, width, wm1, width);
+    subLimbs(wm2, w2, width, wm2, width);
+    sarLimbs(wm2, width, 1);
+    subLimbs(w2, w2, width, wm2, width);
+    sarLimbs(wm2, width, 1);
+
+    subLimbs(w1, w1, width, c0, 2 * k);
+    subLimbs(w1, w1, width, c6, c6n);
+    subLimbs(w2, w2, width, c0, 2 * k);
+    subMulLimb(w2, width, c6, c6n, 64);
+    subMulLimb(w2, width, w1, width, 4);
+    sarLimbs(w2, width, 2);
+    divExactLimb(w2, width, 3);
+    subLimbs(w1, w1, width, w2, width);
+
+    subLimbs(w3, w3, width, c0, 2 * k);
+    subMulLimb(w3, width, w1, width, 9);
+    subMulLimb(w3, width, w2, width, 81);
+    subMulLimb(w3, width, c6, c6n, 729);
+    divExactLimb(w3, width, 3);
+    subLimbs(w3, w3, width, wm2, width);
+    divExactLimb(w3, width, 5);
+    subLimbs(wm2, wm2, width, wm1, width);
+    divExactLimb(wm2, width, 3);
+    subLimbs(w3, w3, width, wm2, width);
+    sarLimbs(w3, width, 3);
+    subMulLimb(wm2, width, w3, width, 5);
+    subLimbs(wm1, wm1, width, wm2, width);
+    subLimbs(wm1, wm1, width, w3, width);
+
+    Limb* w[5] = {wm1, w1, wm2, w2, w3};
+    toomFinish(r, rn, k, w, 5);
+}
+
+template<unsigned Mod>
+void BigInteger::ntt(std::vector<Residue<Mod>>& a, bool invert) {
+    size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+    static const Residue<Mod> root = Residue<Mod>::getPrimitiveRoot();
+    std::vector<Residue<Mod>> roots(std::max<size_t>(n, 2), static_cast<Residue<Mod>>(1));
+    for (size_t len = 2; len <= n; len <<= 1) {
+        Residue<Mod> w = root.pow((Mod - 1) / len);
+        if (invert) {
+            w = w.getInverse();
+        }
+        for (size_t j = len / 2 + 1; j < len; ++j) {
+            roots[j] = roots[j - 1] * w;
+        }
+    }
+    size_t parts = taskPool().size();
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const Residue<Mod>* w = roots.data() + len / 2;
+        auto stage = [&a, w, len](size_t from, size_t to, size_t jFrom, size_t jTo) {
+            for (size_t i = from; i < to; i += len) {
+                for (size_t j = jFrom; j < jTo; ++j) {
+                    Residue<Mod> u = a[i + j];
+                    Residue<Mod> v = a[i + j + len / 2] * w[j];
+                    a[i + j] = u + v;
+                    a[i + j + len / 2] = u - v;
+                }
+            }
+        };
+        TaskGroup group(n / 2);
+        size_t blocks = n / len;
+        for (size_t t = 0; t < parts; ++t) {
+            if (blocks >= parts) {
+                size_t from = blocks * t / parts * len;
+                size_t to = blocks * (t + 1) / parts * len;
+                group.run(nullptr, 0, [=](Limb*) {
+                    stage(from, to, 0, len / 2);
+                });
+            } else {
+                size_t from = len / 2 * t / parts;
+                size_t to = len / 2 * (t + 1) / parts;
+                group.run(nullptr, 0, [=](Limb*) {
+                    stage(0, n, from, to);
+                });
+            }
+        }
+        group.wait();
+    }
+    if (invert) {
+        Residue<Mod> inv = static_cast<Residue<Mod>>(static_cast<int>(n % Mod)).getInverse();
+        for (size_t i = 0; i < n; ++i) {
+            a[i] *= inv;
+        }
+    }
+}
+
+template<unsigned Mod>
+std::vector<uint32_t> BigInteger::nttConvolution(const Limb* a, size_t n, const Limb* b, size_t m, size_t len) {
+    auto load = [len](const Limb* x, size_t xn) {
+        std::vector<Residue<Mod>> ans(len, static_cast<Residue<Mod>>(0));
+        for (size_t i = 0; i < xn; ++i) {
+            ans[2 * i] = static_cast<Residue<Mod>>(static_cast<int>(static_cast<uint32_t>(x[i]) % Mod));
+            ans[2 * i + 1] = static_cast<Residue<Mod>>(static_cast<int>((x[i] >> 32) % Mod));
+        }
+        ntt(ans, false);
+        return ans;
+    };
+    std::vector<Residue<Mod>> fa;
+    std::vector<Residue<Mod>> fb;
+    TaskGroup group(len / 2);
+    if (!(a == b && n == m)) {
+        group.run(nullptr, 0, [&](Limb*) {
+            fb = load(b, m);
+        });
+    }
+    fa = load(a, n);
+    group.wait();
+    if (a == b && n == m) {
+        for (size_t i = 0; i < len; ++i) {
+            fa[i] *= fa[i];
+        }
+    } else {
+        for (size_t i = 0; i < len; ++i) {
+            fa[i] *= fb[i];
+        }
+    }
+    ntt(fa, true);
+    std::vector<uint32_t> ans(len);
+    for (size_t i = 0; i < len; ++i) {
+        ans[i] = static_cast<int>(fa[i]);
+    }
+    return ans;
+}
+
+void BigInteger::mulNtt(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m) {
+    size_t len = 1;
+    while (len < 2 * (n + m)) {
+        len <<= 1;
+    }
+    std::vector<uint32_t> r1;
+    std::vector<uint32_t> r2;
+    std::vector<uint32_t> r3;
+    TaskGroup group(m);
+    group.run(nullptr, 0, [&](Limb*) {
+        r1 = nttConvolution<nttMod1>(a, n, b, m, len);
+    });
+    group.run(nullptr, 0, [&](Limb*) {
+        r2 = nttConvolution<nttMod2>(a, n, b, m, len);
+    });
+    r3 = nttConvolution<nttMod3>(a, n, b, m, len);
+    group.wait();
+
+    Residue<nttMod2> inv1 = static_cast<Residue<nttMod2>>(static_cast<int>(nttMod1)).getInverse();
+    Residue<nttMod3> inv12 = (static_cast<Residue<nttMod3>>(static_cast<int>(nttMod1)) *
+                              static_cast<Residue<nttMod3>>(static_cast<int>(nttMod2))).getInverse();
+    DoubleLimb carry = 0;
+    for (size_t i = 0; i < n + m; ++i) {
+        Limb limb = 0;
+        for (int half = 0; half < 2; ++half) {
+            size_t j = 2 * i + half;
+            Residue<nttMod2> v2 = (static_cast<Residue<nttMod2>>(static_cast<int>(r2[j])) -
+                                   static_cast<Residue<nttMod2>>(static_cast<int>(r1[j]))) * inv1;
+            DoubleLimb low = r1[j] + static_cast<DoubleLimb>(static_cast<int>(v2)) * nttMod1;
+            Residue<nttMod3> v3 = (static_cast<Residue<nttMod3>>(static_cast<int>(r3[j])) -
+                                   static_cast<Residue<nttMod3>>(static_cast<int>(low % nttMod3))) * inv12;
+            carry += low + static_cast<DoubleLimb>(static_cast<int>(v3)) * nttMod1 * nttMod2;
+            limb |= static_cast<Limb>(static_cast<uint32_t>(carry)) << (32 * half);
+            carry >>= 32;
+        }
+        r[i] = limb;
+    }
+}
+
+void BigInteger::mulLimbs(Limb* r, const Limb* a, size_t n, const Limb* b, size_t m, Limb* scratch) {
+    if (n < m) {
+        std::swap(a, b);
+        std::swap(n, m);
+    }
+    if (m < karatsubaThreshold) {
+        if (a == b && n == m) {
+            stupid_sqr(r, a, n);
+        } else {
+            stupid_mul(r, a, n, b, m);
+        }
+        return;
+    }
+    if (m >= nttThreshold && 2 * (n + m) <= nttMaxLength) {
+        mulNtt(r, a, n, b, m);
+        return;
+    }
+    if (m >= toom4Threshold && m > 3 * ((n + 3) / 4)) {
+        toom4(r, a, n, b, m, scratch);
+        return;
+    }
+    if (m >= toom3Threshold && m > 2 * ((n + 2) / 3)) {
+        toom3(r, a, n, b, m, scratch);
+        return;
+    }
+    if (m > (n + 1) / 2) {
+        karatsuba(r, a, n, b, m, scratch);
+        return;
+    }
+    std::fill(r, r + n + m, 0);
+    for (size_t i = 0; i < n; i += m) {
+        size_t len = std::min(m, n - i);
+        mulLimbs(scratch, b, m, a + i, len, scratch + 2 * m);
+        addLimbs(r + i, r + i, n + m - i, scratch, m + len);
+    }
+}
+
+size_t BigInteger::mulScratchSize(size_t n, size_t m) {
+    if (n < m) {
+        std::swap(n, m);
+    }
+    if (m < karatsubaThreshold || (m >= nttThreshold && 2 * (n + m) <= nttMaxLength)) {
+        return 0;
+    }
+    if (m <= (n + 1) / 2) {
+        return 2 * m + mulScratchSize(m, m);
+    }
+    size_t ans = 0;
+    while (n >= karatsubaThreshold) {
+        size_t k = (n + 1) / 2;
+        size_t own = 4 * k + 4;
+        if (n >= toom3Threshold) {
+            own = std::max(own, 3 * (2 * ((n + 2) / 3) + 3) + 5 * ((n + 2) / 3 + 1));
+        }
+        if (n >= toom4Threshold) {
+            own = std::max(own, 5 * (2 * ((n + 3) / 4) + 3) + 5 * ((n + 3) / 4 + 1));
+        }
+        ans += own;
+        n = k + 1;
+    }
+    return ans;
+}
+
+BigInteger& BigInteger::operator*=(const BigInteger& x) {
+    size_t n = num.size();
+    size_t m = x.num.size();
+    LimbVector ans(n + m + mulScratchSize(n, m), 0);
+    mulLimbs(ans.data(), num.data(), n, x.num.data(), m, ans.data() + n + m);
+    ans.resize(n + m);
+    num.swap(ans);
+    isNotNeg = (isNotNeg == x.isNotNeg);
+    normalize();
+    return *this;
+}
+
+void BigInteger::mulBatch(const BigInteger* a, const BigInteger* b, BigInteger* r, const size_t* order, size_t count) {
+    auto mulLanes = limbKernels().mulLanes;
+    std::vector<Limb> buffer;
+    size_t i = 0;
+    while (i < count) {
+        size_t n = a[order[i]].num.size();
+        size_t m = b[order[i]].num.size();
+        size_t run = 1;
+        while (run < batchLanes && i + run < count && a[order[i + run]].num.size() == n &&
+               b[order[i + run]].num.size() == m) {
+            ++run;
+        }
+        if (!mulLanes || run < batchLanes || std::max(n, m) >= karatsubaThreshold) {
+            const BigInteger& x = a[order[i]];
+            const BigInteger& y = b[order[i]];
+            buffer.resize(n + m + mulScratchSize(n, m));
+            mulLimbs(buffer.data(), x.num.data(), n, y.num.data(), m, buffer.data() + n + m);
+            BigInteger& z = r[order[i]];
+            z.isNotNeg = (x.isNotNeg == y.isNotNeg);
+            z.num.resize(n + m);
+            std::copy(buffer.begin(), buffer.begin() + n + m, z.num.begin());
+            z.normalize();
+            ++i;
+            continue;
+        }
+        buffer.resize((5 * (n + m) + 4) * batchLanes);
+        Limb* pa = buffer.data();
+        Limb* pb = pa + n * batchLanes;
+        Limb* pr = pb + m * batchLanes;
+        bool signs[batchLanes];
+        for (size_t l = 0; l < batchLanes; ++l) {
+            const BigInteger& x = a[order[i + l]];
+            const BigInteger& y = b[order[i + l]];
+            for (size_t j = 0; j < n; ++j) {
+                pa[j * batchLanes + l] = x.num[j];
+            }
+            for (size_t j = 0; j < m; ++j) {
+                pb[j * batchLanes + l] = y.num[j];
+            }
+            signs[l] = (x.isNotNeg == y.isNotNeg);
+        }
+        mulLanes(pr, pa, n, pb, m, pr + (n + m) * batchLanes);
+        for (size_t l = 0; l < batchLanes; ++l) {
+            BigInteger& z = r[order[i + l]];
+            z.isNotNeg = signs[l];
+            z.num.resize(n + m);
+            for (size_t j = 0; j < n + m; ++j) {
+                z.num[j] = pr[j * batchLanes + l];
+            }
+            z.normalize();
+        }
+        i += batchLanes;
+    }
+}
+
+void BigInteger::mulMany(std::span<const BigInteger> a, std::span<const BigInteger> b, std::span<BigInteger> r) {
+    size_t count = std::min({a.size(), b.size(), r.size()});
+    std::vector<size_t> order(count);
+    size_t work = 0;
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = i;
+        work += a[i].num.size() + b[i].num.size();
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t i, size_t j) {
+        return std::make_pair(a[i].num.size(), b[i].num.size()) < std::make_pair(a[j].num.size(), b[j].num.size());
+    });
+    size_t threads = taskPool().size();
+    size_t chunk = (count + threads - 1) / threads;
+    chunk = (chunk + batchLanes - 1) / batchLanes * batchLanes;
+    TaskGroup group(work);
+    for (size_t begin = 0; begin < count; begin += chunk) {
+        size_t len = std::min(chunk, count - begin);
+        group.run(nullptr, 0, [=, &order](Limb*) {
+            mulBatch(a.data(), b.data(), r.data(), order.data() + begin, len);
+        });
+    }
+    group.wait();
+}
+
+void BigInteger::shiftLeftLimbs(size_t k) {
+    if (num.size() == 1 && num[0] == 0) {
+        return;
+    }
+    size_t n = num.size();
+    num.resize(n + k);
+    std::copy_backward(num.begin(), num.begin() + n, num.end());
+    std::fill(num.begin(), num.begin() + k, 0);
+}
+
+void BigInteger::shiftRightLimbs(size_t k) {
+    k = std::min(k, num.size());
+    std::copy(num.begin() + k, num.end(), num.begin());
+    num.resize(num.size() - k);
+    normalize();
+}
+
+BigInteger BigInteger::fromLimbs(const Limb* a, size_t n) {
+    BigInteger ans;
+    ans.num.assign(a, a + n);
+    ans.normalize();
+    return ans;
+}
+
+BigInteger::Limb BigInteger::shlLimbs(Limb* r, const Limb* a, size_t n, int s) {
+    if (s == 0) {
+        std::copy(a, a + n, r);
+        return 0;
+    }
+    Limb out = a[n - 1] >> (limbBits - s);
+    for (size_t i = n - 1; i > 0; --i) {
+        r[i] = (a[i] << s) | (a[i - 1] >> (limbBits - s));
+    }
+    r[0] = a[0] << s;
+    return out;
+}
+
+void BigInteger::shrLimbs(Limb* r, const Limb* a, size_t n, int s) {
+    if (s == 0) {
+        std::copy(a, a + n, r);
+        return;
+    }
+    for (size_t i = 0; i + 1 < n; ++i) {
+        r[i] = (a[i] >> s) | (a[i + 1] << (limbBits - s));
+    }
+    r[n - 1] = a[n - 1] >> s;
+}
+
+void BigInteger::divModLimbs(Limb* q, Limb* u, size_t n, const Limb* v, size_t m) {
+    for (size_t j = n - m + 1; j > 0; --j) {
+        Limb* cur = u + j - 1;
+        DoubleLimb top = (static_cast<DoubleLimb>(cur[m]) << limbBits) | cur[m - 1];
+        DoubleLimb qhat = top / v[m - 1];
+        DoubleLimb rhat = top % v[m - 1];
+        while (qhat >> limbBits || qhat * v[m - 2] > ((rhat << limbBits) | cur[m - 2])) {
+            --qhat;
+            rhat += v[m - 1];
+            if (rhat >> limbBits) {
+                break;
+            }
+        }
+        if (subMulLimb(cur, m + 1, v, m, static_cast<Limb>(qhat))) {
+            --qhat;
+            addLimbs(cur, cur, m + 1, v, m);
+        }
+        q[j - 1] = static_cast<Limb>(qhat);
+    }
+}
+
+void BigInteger::divModKnuth(const BigInteger& a, const BigInteger& b, BigInteger& q, BigInteger& r) {
+    size_t n = a.num.size();
+    size_t m = b.num.size();
+    int s = __builtin_clzll(b.num.back());
+    std::vector<Limb> v(m);
+    std::vector<Limb> u(n + 1);
+    shlLimbs(v.data(), b.num.data(), m, s);
+    u[n] = shlLimbs(u.data(), a.num.data(), n, s);
+    q.num.assign(n - m + 1, 0);
+    divModLimbs(q.num.data(), u.data(), n, v.data(), m);
+    r.num.resize(m);
+    shrLimbs(r.num.data(), u.data(), m, s);
+    q.normalize();
+    r.normalize();
+}
+
+BigInteger BigInteger::reciprocal(const BigInteger& b) {
+    size_t m = b.num.size();
+    BigInteger power;
+    power.num.assign(2 * m + 1, 0);
+    power.num.back() = 1;
+    size_t h = m / 2 + 2;
+    if (m < newtonThreshold || h >= m) {
+        BigInteger ans, rem;
+        divModKnuth(power, b, ans, rem);
+        return ans;
+    }
+    BigInteger top = b;
+    top.shiftRightLimbs(m - h);
+    BigInteger ans = reciprocal(top);
+    ans.shiftLeftLimbs(m - h);
+
+    BigInteger err = b;
+    err *= ans;
+    err -= power;
+    err *= ans;
+    err.shiftRightLimbs(2 * m);
+    ans -= err;
+
+    err = b;
+    err *= ans;
+    err.invertSign();
+    err += power;
+    while (!err.isNotNeg) {
+        --ans;
+        err += b;
+    }
+    while (err.compareMagnitude(b) >= 0) {
+        ++ans;
+        err -= b;
+    }
+    return ans;
+}
+
+void BigInteger::divModBarrett(const BigInteger& a, const BigInteger& b, const BigInteger& inv,
+                               BigInteger& q, BigInteger& r) {
+    size_t m = b.num.size();
+    q = a;
+    q.shiftRightLimbs(m - 1);
+    q *= inv;
+    q.shiftRightLimbs(m + 1);
+    r = q;
+    r *= b;
+    r.invertSign();
+    r += a;
+    while (r.compareMagnitude(b) >= 0) {
+        r -= b;
+        ++q;
+    }
+}
+
+void BigInteger::divModNewton(const BigInteger& a, const BigInteger& b, BigInteger& q, BigInteger& r) {
+    size_t n = a.num.size();
+    size_t m = b.num.size();
+    BigInteger inv = reciprocal(b);
+    if (n <= 2 * m) {
+        divModBarrett(a, b, inv, q, r);
+        return;
+    }
+    LimbVector ans(n, 0);
+    r = 0;
+    BigInteger cur, part;
+    for (size_t end = n; end > 0; ) {
+        size_t from = end >= m ? end - m : 0;
+        cur = r;
+        cur.shiftLeftLimbs(end - from);
+        cur += fromLimbs(a.num.data() + from, end - from);
+        divModBarrett(cur, b, inv, part, r);
+        std::copy(part.num.begin(), part.num.end(), ans.begin() + from);
+        end = from;
+    }
+    q.num.swap(ans);
+    q.isNotNeg = true;
+    q.normalize();
+}
+
+void BigInteger::divModAbs(const BigInteger& a, const BigInteger& b, BigInteger& q, BigInteger& r) {
+    size_t n = a.num.size();
+    size_t m = b.num.size();
+    if (a.compareMagnitude(b) < 0) {
+        r.num = a.num;
+        r.isNotNeg = true;
+        q = 0;
+    } else if (m == 1) {
+        Limb d = b.num[0];
+        q.num = a.num;
+        q.isNotNeg = true;
+        r = 0;
+        r.num[0] = q.divSmall(d);
+    } else if (m >= newtonThreshold && n - m + 1 >= newtonThreshold) {
+        BigInteger aa = a;
+        BigInteger bb = b;
+        aa.isNotNeg = bb.isNotNeg = true;
+        divModNewton(aa, bb, q, r);
+    } else {
+        divModKnuth(a, b, q, r);
+    }
+    q.isNotNeg = r.isNotNeg = true;
+}
+
+void BigInteger::divmod(const BigInteger& x, BigInteger& quotient, BigInteger& remainder) const {
+    bool quotientSign = (isNotNeg == x.isNotNeg);
+    bool remainderSign = isNotNeg;
+    if (&quotient == this || &quotient == &x || &remainder == this || &remainder == &x) {
+        BigInteger q, r;
+        divModAbs(*this, x, q, r);
+        quotient.num.swap(q.num);
+        remainder.num.swap(r.num);
+    } else {
+        divModAbs(*this, x, quotient, remainder);
+    }
+    quotient.isNotNeg = quotientSign;
+    remainder.isNotNeg = remainderSign;
+    quotient.normalize();
+    remainder.normalize();
+}
+
+std::pair<BigInteger, BigInteger> BigInteger::divmod(const BigInteger& x) const {
+    std::pair<BigInteger, BigInteger> ans;
+    divmod(x, ans.first, ans.second);
+    return ans;
+}
+
+BigInteger& BigInteger::divAssign(const BigInteger& x, BigInteger& remainder) {
+    divmod(x, *this, remainder);
+    return *this;
+}
+
+BigInteger& BigInteger::modAssign(const BigInteger& x, BigInteger& quotient) {
+    divmod(x, quotient, *this);
+    return *this;
+}
+
+BigInteger& BigInteger::operator/=(const BigInteger& x) {
+    BigInteger r;
+    return divAssign(x, r);
+}
+
+BigInteger& BigInteger::operator%=(const BigInteger& x) {
+    BigInteger q;
+    return modAssign(x, q);
+}
+
+BigInteger operator ""_bi(unsigned long long x) {
+    return BigInteger(x);
+}
+
+BigInteger operator+(const BigInteger& a, const BigInteger& b) {
+    BigInteger x = a;
+    x += b;
+    return x;
+}
+
+BigInteger operator+(BigInteger&& a, const BigInteger& b) {
+    a += b;
+    return std::move(a);
+}
+
+BigInteger operator+(const BigInteger& a, BigInteger&& b) {
+    b += a;
+    return std::move(b);
+}
+
+BigInteger operator+(BigInteger&& a, BigInteger&& b) {
+    a += b;
+    return std::move(a);
+}
+
+BigInteger operator-(const BigInteger& a, const BigInteger& b) {
+    BigInteger x = a;
+    x -= b;
+    return x;
+}
+
+BigInteger operator-(BigInteger&& a, const BigInteger& b) {
+    a -= b;
+    return std::move(a);
+}
+
+BigInteger operator-(const BigInteger& a, BigInteger&& b) {
+    b -= a;
+    b.invertSign();
+    return std::move(b);
+}
+
+BigInteger operator-(BigInteger&& a, BigInteger&& b) {
+    a -= b;
+    return std::move(a);
+}
+
+BigInteger operator*(const BigInteger& a, const BigInteger& b) {
+    BigInteger x = a;
+    x *= b;
+    return x;
+}
+
+BigInteger operator*(BigInteger&& a, const BigInteger& b) {
+    a *= b;
+    return std::move(a);
+}
+
+BigInteger operator*(const BigInteger& a, BigInteger&& b) {
+    b *= a;
+    return std::move(b);
+}
+
+BigInteger operator*(BigInteger&& a, BigInteger&& b) {
+    a *= b;
+    return std::move(a);
+}
+
+BigInteger operator/(const BigInteger& a, const BigInteger& b) {
+    BigInteger x = a;
+    x /= b;
+    return x;
+}
+
+BigInteger operator/(BigInteger&& a, const BigInteger& b) {
+    a /= b;
+    return std::move(a);
+}
+
+BigInteger operator%(const BigInteger& a, const BigInteger& b) {
+    BigInteger x = a;
+    x %= b;
+    return x;
+}
+
+BigInteger operator%(BigInteger&& a, const BigInteger& b) {
+    a %= b;
+    return std::move(a);
+}
+
+template<size_t K>
+BigInteger::Limb BigInteger::addColumns(Limb* r, size_t n, const Limb* const* src, const Limb* mask,
+                                        size_t count, Limb carry) {
+    size_t k = K ? K : count;
+    for (size_t i = 0; i < n; ++i) {
+        DoubleLimb cur = 0;
+        for (size_t j = 0; j < k; ++j) {
+            cur += src[j][i] ^ mask[j];
+        }
+        cur += carry;
+        r[i] = static_cast<Limb>(cur);
+        carry = static_cast<Limb>(cur >> limbBits);
+    }
+    return carry;
+}
+
+BigInteger BigInteger::evaluateLazy(const LazyTerm* terms, size_t count) {
+    size_t width = 0;
+    size_t productSize = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t n = terms[i].a->num.size();
+        if (terms[i].b) {
+            size_t m = terms[i].b->num.size();
+            width = std::max(width, n + m);
+            productSize = std::max(productSize, n + m + mulScratchSize(n, m));
+        } else {
+            width = std::max(width, n);
+        }
+    }
+    ++width;
+
+    BigInteger ans;
+    ans.num.assign(width, 0);
+    LimbVector product(productSize, 0);
+    bool isFirst = true;
+    for (size_t i = 0; i < count; ++i) {
+        if (!terms[i].b) {
+            continue;
+        }
+        const BigInteger& a = *terms[i].a;
+        const BigInteger& b = *terms[i].b;
+        size_t n = a.num.size();
+        size_t m = b.num.size();
+        bool negative = terms[i].negative != (a.isNotNeg != b.isNotNeg);
+        if (isFirst) {
+            mulLimbs(ans.num.data(), a.num.data(), n, b.num.data(), m, product.data());
+            if (negative) {
+                negLimbs(ans.num.data(), width);
+            }
+            isFirst = false;
+        } else {
+            mulLimbs(product.data(), a.num.data(), n, b.num.data(), m, product.data() + n + m);
+            if (negative) {
+                subLimbs(ans.num.data(), ans.num.data(), width, product.data(), n + m);
+            } else {
+                addLimbs(ans.num.data(), ans.num.data(), width, product.data(), n + m);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count && width < lazyColumnThreshold; ++i) {
+        const BigInteger& a = *terms[i].a;
+        if (terms[i].b) {
+            continue;
+        }
+        if (terms[i].negative == a.isNotNeg) {
+            subLimbs(ans.num.data(), ans.num.data(), width, a.num.data(), a.num.size());
+        } else if (isFirst) {
+            std::copy(a.num.begin(), a.num.end(), ans.num.begin());
+        } else {
+            addLimbs(ans.num.data(), ans.num.data(), width, a.num.data(), a.num.size());
+        }
+        isFirst = false;
+    }
+    for (size_t from = 0; from < count && width >= lazyColumnThreshold; ) {
+        const Limb* src[lazyColumnTerms];
+        Limb mask[lazyColumnTerms];
+        size_t size[lazyColumnTerms];
+        size_t k = 0;
+        size_t common = width;
+        Limb carry = 0;
+        if (!isFirst) {
+            src[k] = ans.num.data();
+            size[k] = width;
+            mask[k++] = 0;
+        }
+        for (; from < count && k < lazyColumnTerms; ++from) {
+            const BigInteger& a = *terms[from].a;
+            if (terms[from].b) {
+                continue;
+            }
+            src[k] = a.num.data();
+            size[k] = a.num.size();
+            mask[k] = 0;
+            if (terms[from].negative == a.isNotNeg) {
+                mask[k] = ~static_cast<Limb>(0);
+                ++carry;
+            }
+            common = std::min(common, size[k]);
+            ++k;
+        }
+        if (k == (isFirst ? 0 : 1)) {
+            break;
+        }
+        isFirst = false;
+        switch (k) {
+            case 2:
+                carry = addColumns<2>(ans.num.data(), common, src, mask, k, carry);
+                break;
+            case 3:
+                carry = addColumns<3>(ans.num.data(), common, src, mask, k, carry);
+                break;
+            default:
+                carry = addColumns<0>(ans.num.data(), common, src, mask, k, carry);
+        }
+        for (size_t i = common; i < width; ++i) {
+            DoubleLimb cur = carry;
+            for (size_t j = 0; j < k; ++j) {
+                cur += (i < size[j] ? src[j][i] : 0) ^ mask[j];
+            }
+            ans.num[i] = static_cast<Limb>(cur);
+            carry = static_cast<Limb>(cur >> limbBits);
+        }
+    }
+
+    if (ans.num[width - 1] >> (limbBits - 1)) {
+        negLimbs(ans.num.data(), width);
+        ans.isNotNeg = false;
+    }
+    ans.normalize();
+    return ans;
+}
+
+template<typename Expr>
+class LazyExpr {
+  public:
+    operator BigInteger() const {
+        BigInteger::LazyTerm terms[Expr::termCount];
+        size_t count = 0;
+        static_cast<const Expr&>(*this).collect(terms, count, false);
+        return BigInteger::evaluateLazy(terms, count);
+    }
+};
+
+class LazyRef : public LazyExpr<LazyRef> {
+  private:
+    const BigInteger& x;
+
+  public:
+    static const size_t termCount = 1;
+
+    explicit LazyRef(const BigInteger& xx) : x(xx) {}
+
+    const BigInteger& get() const {
+        return x;
+    }
+
+    void collect(BigInteger::LazyTerm* terms, size_t& count, bool negative) const {
+        terms[count++] = {&x, nullptr, negative};
+    }
+};
+
+class LazyProduct : public LazyExpr<LazyProduct> {
+  private:
+    const BigInteger& a;
+    const BigInteger& b;
+
+  public:
+    static const size_t termCount = 1;
+
+    LazyProduct(const BigInteger& aa, const BigInteger& bb) : a(aa), b(bb) {}
+
+    void collect(BigInteger::LazyTerm* terms, size_t& count, bool negative) const {
+        terms[count++] = {&a, &b, negative};
+    }
+};
+
+template<typename L, typename R, bool Subtract>
+class LazySum : public LazyExpr<LazySum<L, R, Subtract>> {
+  private:
+    L left;
+    R right;
+
+  public:
+    static const size_t termCount = L::termCount + R::termCount;
+
+    LazySum(const L& l, const R& r) : left(l), right(r) {}
+
+    void collect(BigInteger::LazyTerm* terms, size_t& count, bool negative) const {
+        left.collect(terms, count, negative);
+        right.collect(terms, count, negative != Subtract);
+    }
+};
+
+template<typename E>
+class LazyNegate : public LazyExpr<LazyNegate<E>> {
+  private:
+    E x;
+
+  public:
+    static const size_t termCount = E::termCount;
+
+    explicit LazyNegate(const E& e) : x(e) {}
+
+    void collect(BigInteger::LazyTerm* terms, size_t& count, bool negative) const {
+        x.collect(terms, count, !negative);
+    }
+};
+
+LazyRef lazy(const BigInteger& x) {
+    return LazyRef(x);
+}
+
+LazyRef lazy(BigInteger&& x) = delete;
+
+template<typename L, typename R>
+LazySum<L, R, false> operator+(const LazyExpr<L>& a, const LazyExpr<R>& b) {
+    return LazySum<L, R, false>(static_cast<const L&>(a), static_cast<const R&>(b));
+}
+
+template<typename L>
+LazySum<L, LazyRef, false> operator+(const LazyExpr<L>& a, const BigInteger& b) {
+    return LazySum<L, LazyRef, false>(static_cast<const L&>(a), LazyRef(b));
+}
+
+template<typename R>
+LazySum<LazyRef, R, false> operator+(const BigInteger& a, const LazyExpr<R>& b) {
+    return LazySum<LazyRef, R, false>(LazyRef(a), static_cast<const R&>(b));
+}
+
+template<typename L, typename R>
+LazySum<L, R, true> operator-(const LazyExpr<L>& a, const LazyExpr<R>& b) {
+    return LazySum<L, R, true>(static_cast<const L&>(a), static_cast<const R&>(b));
+}
+
+template<typename L>
+LazySum<L, LazyRef, true> operator-(const LazyExpr<L>& a, const BigInteger& b) {
+    return LazySum<L, LazyRef, true>(static_cast<const L&>(a), LazyRef(b));
+}
+
+template<typename R>
+LazySum<LazyRef, R, true> operator-(const BigInteger& a, const LazyExpr<R>& b) {
+    return LazySum<LazyRef, R, true>(LazyRef(a), static_cast<const R&>(b));
+}
+
+template<typename E>
+LazyNegate<E> operator-(const LazyExpr<E>& x) {
+    return LazyNegate<E>(static_cast<const E&>(x));
+}
+
+template<typename L>
+void operator+(const LazyExpr<L>& a, BigInteger&& b) = delete;
+
+template<typename R>
+void operator+(BigInteger&& a, const LazyExpr<R>& b) = delete;
+
+template<typename L>
+void operator-(const LazyExpr<L>& a, BigInteger&& b) = delete;
+
+template<typename R>
+void operator-(BigInteger&& a, const LazyExpr<R>& b) = delete;
+
+LazyProduct operator*(const LazyRef& a, const LazyRef& b) {
+    return LazyProduct(a.get(), b.get());
+}
+
+LazyProduct operator*(const LazyRef& a, const BigInteger& b) {
+    return LazyProduct(a.get(), b);
+}
+
+LazyProduct operator*(const BigInteger& a, const LazyRef& b) {
+    return LazyProduct(a, b.get());
+}
+
+void operator*(const LazyRef& a, BigInteger&& b) = delete;
+
+void operator*(BigInteger&& a, const LazyRef& b) = delete;
+
+const BigInteger& BigInteger::decimalPower(size_t k) {
+    static std::atomic<const BigInteger*> built[decimalPowers] = {};
+    static std::deque<BigInteger> powers;
+    static std::mutex mutex;
+    if (const BigInteger* ans = built[k].load(std::memory_order_acquire)) {
+        return *ans;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (powers.empty()) {
+        powers.push_back(BigInteger(0));
+        powers.back().num[0] = decimalBase;
+        built[0].store(&powers.back(), std::memory_order_release);
+    }
+    while (powers.size() <= k) {
+        powers.push_back(powers.back() * powers.back());
+        built[powers.size() - 1].store(&powers.back(), std::memory_order_release);
+    }
+    return powers[k];
+}
+
+BigInteger BigInteger::powerOfTen(size_t k) {
+    BigInteger ans(1);
+    for (size_t i = 0; i < k % decimalDigits; ++i) {
+        ans.num[0] *= 10;
+    }
+    k /= decimalDigits;
+    for (size_t j = 0; k != 0; ++j, k >>= 1) {
+        if (k & 1) {
+            ans *= decimalPower(j);
+        }
+    }
+    return ans;
+}
+
+char* BigInteger::writeDecimal(const BigInteger& x, char* out) {
+    if (x.num.size() <= radixThreshold) {
+        std::vector<Limb> chunks;
+        BigInteger a = x;
+        do {
+            chunks.push_back(a.divSmall(decimalBase));
+        } while (a.num.size() > 1 || a.num[0] != 0);
+        out = std::to_chars(out, out + decimalDigits + 1, chunks.back()).ptr;
+        for (size_t i = chunks.size() - 1; i > 0; --i) {
+            Limb chunk = chunks[i - 1];
+            for (int j = decimalDigits; j > 0; --j) {
+                out[j - 1] = static_cast<char>('0' + chunk % 10);
+                chunk /= 10;
+            }
+            out += decimalDigits;
+        }
+        return out;
+    }
+    size_t k = 0;
+    while (decimalPower(k + 1).compareMagnitude(x) <= 0) {
+        ++k;
+    }
+    BigInteger hi, lo;
+    divModAbs(x, decimalPower(k), hi, lo);
+    out = writeDecimal(hi, out);
+    writeDecimalPadded(lo, k, out);
+    return out + (static_cast<size_t>(decimalDigits) << k);
+}
+
+void BigInteger::writeDecimalPadded(const BigInteger& x, size_t k, char* out) {
+    if (k == 0 || x.num.size() <= radixThreshold) {
+        BigInteger a = x;
+        char* cur = out + (static_cast<size_t>(decimalDigits) << k);
+        while (cur != out && (a.num.size() > 1 || a.num[0] != 0)) {
+            Limb chunk = a.divSmall(decimalBase);
+            for (int j = 0; j < decimalDigits; ++j) {
+                *--cur = static_cast<char>('0' + chunk % 10);
+                chunk /= 10;
+            }
+        }
+        std::memset(out, '0', cur - out);
+        return;
+    }
+    BigInteger hi, lo;
+    divModAbs(x, decimalPower(k - 1), hi, lo);
+    writeDecimalPadded(hi, k - 1, out);
+    writeDecimalPadded(lo, k - 1, out + (static_cast<size_t>(decimalDigits) << (k - 1)));
+}
+
+BigInteger BigInteger::parseDecimal(const char* s, size_t len) {
+    BigInteger ans;
+    if (len <= radixThreshold * decimalDigits) {
+        ans.num.reserve(len / decimalDigits + 1);
+        size_t cur = len == 0 ? 0 : (len - 1) % decimalDigits + 1;
+        for (size_t i = 0; i < len; i += cur, cur = decimalDigits) {
+            Limb a = 0;
+            Limb p = 1;
+            for (size_t j = i; j < i + cur; ++j) {
+                a = a * 10 + (s[j] - '0');
+                p *= 10;
+            }
+            ans.mulSmall(p, a);
+        }
+        return ans;
+    }
+    size_t k = 0;
+    while ((static_cast<size_t>(decimalDigits) << (k + 1)) < len) {
+        ++k;
+    }
+    size_t low = static_cast<size_t>(decimalDigits) << k;
+    ans = parseDecimal(s, len - low);
+    ans *= decimalPower(k);
+    ans += parseDecimal(s + len - low, low);
+    return ans;
+}
+
+size_t BigInteger::maxChars() const {
+    size_t bits = num.size() * limbBits - __builtin_clzll(num.back() | 1);
+    return bits * 1234 / 4096 + 2;
+}
+
+std::to_chars_result BigInteger::toChars(char* first, char* last) const {
+    // log10(2) * 2^64 rounded down: the digit count lies in [lower, upper],
+    // and only a buffer inside that window needs an exact comparison.
+    const unsigned __int128 log2 = 0x4d104d427de7fbcc;
+    size_t bits = bitLength();
+    size_t lower = bits == 0 ? 1 : static_cast<size_t>((bits - 1) * log2 >> 64) + 1;
+    size_t upper = static_cast<size_t>(bits * (log2 + 1) >> 64) + 1;
+    size_t size = last - first;
+    size_t sign = isNotNeg ? 0 : 1;
+    if (size < sign + upper && (size < sign + lower || compareMagnitude(powerOfTen(size - sign)) >= 0)) {
+        return {last, std::errc::value_too_large};
+    }
+    if (!isNotNeg) {
+        *first++ = '-';
+    }
+    return {writeDecimal(*this, first), std::errc()};
+}
+
+std::from_chars_result BigInteger::fromChars(const char* first, const char* last, BigInteger& value) {
+    const char* i = first;
+    bool sign = true;
+    if (i != last && (*i == '-' || *i == '+')) {
+        sign = *i == '+';
+        ++i;
+    }
+    const char* digits = i;
+    while (i != last && *i == '0') {
+        ++i;
+    }
+    const char* j = i;
+    while (j != last && *j >= '0' && *j <= '9') {
+        ++j;
+    }
+    if (j == digits) {
+        return {first, std::errc::invalid_argument};
+    }
+    value = parseDecimal(i, j - i);
+    value.isNotNeg = sign;
+    value.normalize();
+    return {j, std::errc()};
+}
+
+BigInteger BigInteger::fromChars(std::string_view str) {
+    BigInteger ans;
+    std::from_chars_result res = fromChars(str.data(), str.data() + str.size(), ans);
+    if (res.ec != std::errc() || res.ptr != str.data() + str.size()) {
+        throw std::invalid_argument("BigInteger::fromChars: not a decimal integer");
+    }
+    return ans;
+}
+
+void BigInteger::storeLimbs(std::byte* out, const Limb* a, size_t n) {
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(out, a, n * sizeof(Limb));
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < sizeof(Limb); ++j) {
+            out[i * sizeof(Limb) + j] = static_cast<std::byte>(a[i] >> (8 * j));
+        }
+    }
+}
+
+void BigInteger::loadLimbs(Limb* r, const std::byte* in, size_t n) {
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(r, in, n * sizeof(Limb));
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        r[i] = 0;
+        for (size_t j = 0; j < sizeof(Limb); ++j) {
+            r[i] |= static_cast<Limb>(in[i * sizeof(Limb) + j]) << (8 * j);
+        }
+    }
+}
+
+bool BigInteger::readHeader(std::span<const std::byte> in, Limb& tag, size_t& count) {
+    if (in.size() < sizeof(Limb)) {
+        return false;
+    }
+    Limb header;
+    loadLimbs(&header, in.data(), 1);
+    tag = (header >> 8) & 0xff;
+    count = header >> 16;
+    return (header & 0xff) == serialVersion;
+}
+
+size_t BigInteger::serializedSize() const {
+    return (num.size() + 1) * sizeof(Limb);
+}
+
+std::byte* BigInteger::serialize(std::span<std::byte> out) const {
+    if (out.size() < serializedSize()) {
+        return nullptr;
+    }
+    Limb header = serialVersion | (isNotNeg ? 0 : serialNegative) << 8 | static_cast<Limb>(num.size()) << 16;
+    storeLimbs(out.data(), &header, 1);
+    storeLimbs(out.data() + sizeof(Limb), num.data(), num.size());
+    return out.data() + serializedSize();
+}
+
+const std::byte* BigInteger::deserialize(std::span<const std::byte> in, BigInteger& x) {
+    Limb tag;
+    size_t count;
+    if (!readHeader(in, tag, count) || tag > serialNegative || count > in.size() / sizeof(Limb) - 1) {
+        return nullptr;
+    }
+    x.num.resize(std::max<size_t>(count, 1));
+    x.num[0] = 0;
+    loadLimbs(x.num.data(), in.data() + sizeof(Limb), count);
+    x.isNotNeg = tag != serialNegative;
+    x.normalize();
+    return in.data() + (count + 1) * sizeof(Limb);
+}
+
+std::span<const BigInteger::Limb> BigInteger::viewSerialized(std::span<const std::byte> in, bool& isNotNeg) {
+    Limb tag;
+    size_t count;
+    if (std::endian::native != std::endian::little || reinterpret_cast<uintptr_t>(in.data()) % alignof(Limb) != 0 ||
+        !readHeader(in, tag, count) || tag > serialNegative || count > in.size() / sizeof(Limb) - 1) {
+        return {};
+    }
+    isNotNeg = tag != serialNegative;
+    return std::span<const Limb>(reinterpret_cast<const Limb*>(in.data()) + 1, count);
+}
+
+size_t BigInteger::serializedSize(std::span<const BigInteger> values) {
+    size_t ans = sizeof(Limb);
+    for (const BigInteger& x : values) {
+        ans += x.serializedSize();
+    }
+    return ans;
+}
+
+std::byte* BigInteger::serializeMany(std::span<const BigInteger> values, std::span<std::byte> out) {
+    if (out.size() < serializedSize(values)) {
+        return nullptr;
+    }
+    Limb header = serialVersion | serialArray << 8 | static_cast<Limb>(values.size()) << 16;
+    storeLimbs(out.data(), &header, 1);
+    std::byte* cur = out.data() + sizeof(Limb);
+    for (const BigInteger& x : values) {
+        cur = x.serialize(std::span<std::byte>(cur, out.data() + out.size()));
+    }
+    return cur;
+}
+
+const std::byte* BigInteger::deserializeMany(std::span<const std::byte> in, std::vector<BigInteger>& values) {
+    Limb tag;
+    size_t count;
+    if (!readHeader(in, tag, count) || tag != serialArray || count > in.size() / sizeof(Limb) - 1) {
+        return nullptr;
+    }
+    const std::byte* cur = in.data() + sizeof(Limb);
+    const std::byte* last = in.data() + in.size();
+    size_t first = values.size();
+    values.resize(first + count);
+    for (size_t i = 0; i < count; ++i) {
+        cur = deserialize(std::span<const std::byte>(cur, last), values[first + i]);
+        if (!cur) {
+            values.resize(first);
+            return nullptr;
+        }
+    }
+    return cur;
+}
+
+std::istream& operator>>(std::istream& in, BigInteger& x) {
+    std::istream::sentry sentry(in);
+    if (!sentry) {
+        return in;
+    }
+    std::string cur;
+    if (in.peek() == '-' || in.peek() == '+') {
+        cur += static_cast<char>(in.get());
+    }
+    while (in.peek() >= '0' && in.peek() <= '9') {
+        cur += static_cast<char>(in.get());
+    }
+    if (BigInteger::fromChars(cur.data(), cur.data() + cur.size(), x).ec != std::errc()) {
+        in.setstate(std::ios_base::failbit);
+    }
+    return in;
+}
+
+std::ostream& operator<<(std::ostream& out, const BigInteger& x) {
+    std::string num = x.toString();
+    out << num;
+    return out;
+}
+
+struct BigInteger::GcdMatrix {
+    BigInteger m[2][2] = {{1, 0}, {0, 1}};
+    int det = 1;
+    bool changed = false;
+
+    void mulQuotient(const BigInteger& q) {
+        for (int i = 0; i < 2; ++i) {
+            BigInteger cur = m[i][0] * q;
+            cur += m[i][1];
+            m[i][1] = std::move(m[i][0]);
+            m[i][0] = std::move(cur);
+        }
+        det = -det;
+        changed = true;
+    }
 
+    void mulCofactors(long long n00, long long n01, long long n10, long long n11, int d) {
+        for (int i = 0; i < 2; ++i) {
+            BigInteger first = m[i][0] * n00 + m[i][1] * n10;
+            BigInteger second = m[i][0] * n01 + m[i][1] * n11;
+            m[i][0] = std::move(first);
+            m[i][1] = std::move(second);
+        }
+        det *= d;
+        changed = true;
+    }
 
-bool operator==(const BigInteger& a, const BigInteger& x) {
-    return !(a.getSign() != x.getSign() || a.getLength() != x.getLength() || a.getNum() != x.getNum());
-}
+    void mulRight(const GcdMatrix& N) {
+        for (int i = 0; i < 2; ++i) {
+            BigInteger first = m[i][0] * N.m[0][0] + m[i][1] * N.m[1][0];
+            BigInteger second = m[i][0] * N.m[0][1] + m[i][1] * N.m[1][1];
+            m[i][0] = std::move(first);
+            m[i][1] = std::move(second);
+        }
+        det *= N.det;
+        changed = true;
+    }
 
-bool operator!=(const BigInteger& a, const BigInteger& x) {
-    return !(a == x);
-}
+    void negateColumn(int j) {
+        m[0][j].invertSign();
+        m[1][j].invertSign();
+        det = -det;
+    }
 
-bool operator<(const BigInteger& a, const BigInteger& x) {
-    bool asign = a.getSign();
-    bool xsign = x.getSign();
-    if (!asign && !xsign) {
-        return -x < -a;
-    } else if (!asign) {
-        return true;
-    } else if (!xsign) {
-        return false;
+    void swapColumns() {
+        std::swap(m[0][0], m[0][1]);
+        std::swap(m[1][0], m[1][1]);
+        det = -det;
     }
-    size_t len1 = a.getLength();
-    size_t len2 = x.getLength();
-    if (len1 != len2) {
-        return len1 < len2;
+};
+
+BigInteger::Limb BigInteger::gcdLimb(Limb a, Limb b) {
+    if (a == 0 || b == 0) {
+        return a | b;
     }
-    std::vector<int> anum = a.getNum(),
-                      xnum = x.getNum();
-    for (int i = static_cast<int>(anum.size()) - 1; i >= 0; --i) {
-        if (anum[i] != xnum[i]) {
-            return anum[i] < xnum[i];
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b) {
+        b >>= __builtin_ctzll(b);
+        if (a > b) {
+            std::swap(a, b);
         }
+        b -= a;
     }
-    return false;
+    return a << shift;
 }
 
-bool operator<=(const BigInteger& a, const BigInteger& x) {
-    return !(x < a);
+BigInteger::Limb BigInteger::topBits(const BigInteger& a, size_t shift) {
+    size_t i = shift / limbBits;
+    int s = shift % limbBits;
+    if (i >= a.num.size()) {
+        return 0;
+    }
+    Limb ans = a.num[i] >> s;
+    if (s != 0 && i + 1 < a.num.size()) {
+        ans |= a.num[i + 1] << (limbBits - s);
+    }
+    return ans;
 }
 
-bool operator>(const BigInteger& a, const BigInteger& x) {
-    return x < a;
+void BigInteger::lehmerCombine(BigInteger& r, const BigInteger& a, const BigInteger& b, long long u, long long v) {
+    size_t n = a.num.size();
+    r.num.resize(n);
+    __int128 carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        __int128 cur = carry + static_cast<__int128>(u) * a.num[i];
+        if (i < b.num.size()) {
+            cur += static_cast<__int128>(v) * b.num[i];
+        }
+        r.num[i] = static_cast<Limb>(cur);
+        carry = cur >> limbBits;
+    }
+    r.isNotNeg = true;
+    r.normalize();
 }
 
-bool operator>=(const BigInteger& a, const BigInteger& x) {
-    return !(a < x);
+void BigInteger::divisionStep(BigInteger& a, BigInteger& b, GcdMatrix* M) {
+    BigInteger q, r;
+    divModAbs(a, b, q, r);
+    if (M) {
+        M->mulQuotient(q);
+    }
+    a.num.swap(b.num);
+    b.num.swap(r.num);
 }
 
-BigInteger::operator bool() const {
-    return *this != 0;
+void BigInteger::lehmerStep(BigInteger& a, BigInteger& b, GcdMatrix* M) {
+    size_t bits = a.num.size() * limbBits - __builtin_clzll(a.num.back());
+    size_t shift = bits > 62 ? bits - 62 : 0;
+    long long x = static_cast<long long>(topBits(a, shift));
+    long long y = static_cast<long long>(topBits(b, shift));
+    long long A = 1;
+    long long B = 0;
+    long long C = 0;
+    long long D = 1;
+    while (y + C != 0 && y + D != 0) {
+        long long q = (x + A) / (y + C);
+        if (q != (x + B) / (y + D)) {
+            break;
+        }
+        long long cur = A - q * C;
+        A = C;
+        C = cur;
+        cur = B - q * D;
+        B = D;
+        D = cur;
+        cur = x - q * y;
+        x = y;
+        y = cur;
+    }
+    if (B == 0) {
+        divisionStep(a, b, M);
+        return;
+    }
+    BigInteger first, second;
+    lehmerCombine(first, a, b, A, B);
+    lehmerCombine(second, a, b, C, D);
+    if (M) {
+        int d = (static_cast<__int128>(A) * D - static_cast<__int128>(B) * C) > 0 ? 1 : -1;
+        M->mulCofactors(d * D, -d * B, -d * C, d * A, d);
+    }
+    a.num.swap(first.num);
+    b.num.swap(second.num);
 }
 
-BigInteger& BigInteger::operator+=(const BigInteger& x) {
-    BigInteger cur;
-    if ((*this < 0 && x > 0) || (*this > 0 && x < 0)) {
-        return *this -= -x;
+void BigInteger::applyInverse(BigInteger& a, BigInteger& b, GcdMatrix& N) {
+    BigInteger c = N.m[1][1] * a - N.m[0][1] * b;
+    BigInteger d = N.m[0][0] * b - N.m[1][0] * a;
+    if (N.det < 0) {
+        c.invertSign();
+        d.invertSign();
     }
-    if (*this == 0 && x < 0) {
-        this->isNotNeg = false;
+    if (!c.isNotNeg) {
+        c.invertSign();
+        N.negateColumn(0);
     }
-    for (size_t i = 0; i < x.num.size(); ++i) {
-        if (i >= num.size()) {
-            num.push_back(0);
-        }
-        num[i] += x.num[i];
+    if (!d.isNotNeg) {
+        d.invertSign();
+        N.negateColumn(1);
     }
-    num.push_back(0);
-    for (size_t i = 0; i + 1 < num.size(); ++i) {
-        if (num[i] >= base) {
-            num[i] -= base;
-            ++num[i + 1];
-        }
+    if (c.compareMagnitude(d) < 0) {
+        std::swap(c, d);
+        N.swapColumns();
     }
-    normalize();
-    return *this;
+    a = std::move(c);
+    b = std::move(d);
 }
 
-BigInteger& BigInteger::operator-=(const BigInteger& x) {
-    if ((!this->isNotNeg && x.isNotNeg) || (this->isNotNeg && !x.isNotNeg)) {
-        return *this += -x;
-    }
-    if ((x.isNotNeg && x > *this) || (!x.isNotNeg && x < *this)) {
-        BigInteger cur = x;
-        cur -= *this;
-        return *this = -cur;
+void BigInteger::reduceHigh(BigInteger& a, BigInteger& b, GcdMatrix* M, size_t p) {
+    if (b.num.size() <= p + 1) {
+        return;
     }
-
-    for (size_t i = 0; i < x.num.size(); ++i) {
-        num[i] -= x.num[i];
+    BigInteger high = fromLimbs(a.num.data() + p, a.num.size() - p);
+    BigInteger low = fromLimbs(b.num.data() + p, b.num.size() - p);
+    GcdMatrix N;
+    halfGcd(high, low, &N);
+    if (!N.changed) {
+        return;
     }
-    for (size_t i = 0; i < num.size(); ++i) {
-        if (num[i] < 0) {
-            num[i] += base;
-            --num[i + 1];
-        }
+    applyInverse(a, b, N);
+    if (M) {
+        M->mulRight(N);
     }
-
-    normalize();
-    return *this;
 }
 
-BigInteger BigInteger::stupid_mul(const BigInteger& a, const BigInteger& x) {
-    BigInteger ans = 0;
-    ans.num.resize(a.num.size() + x.num.size(), 0);
-    for (size_t i = 0; i < a.num.size(); ++i) {
-        if (a.num[i] == 0) {
-            continue;
+void BigInteger::halfGcd(BigInteger& a, BigInteger& b, GcdMatrix* M) {
+    size_t n = a.num.size();
+    size_t s = n / 2 + 1;
+    if (n >= hgcdThreshold) {
+        reduceHigh(a, b, M, n / 2);
+        if (b.num.size() > s) {
+            divisionStep(a, b, M);
         }
-        int nxt = 0;
-        size_t j = 0;
-        for (j = 0; j < x.num.size(); ++j) {
-            long long cur = static_cast<long long>(a.num[i]) * x.num[j] + nxt + ans.num[i + j];
-            ans.num[i + j] = cur % base;
-            nxt = cur / base;
-        }
-        while (nxt) {
-            long long cur = static_cast<long long>(nxt) + ans.num[i + j];
-            ans.num[i + j] = cur % base;
-            nxt = cur / base;
-            ++j;
+        size_t len = a.num.size();
+        if (b.num.size() > s && len > s + 2) {
+            reduceHigh(a, b, M, 2 * s - len + 1);
         }
     }
+    while (b.num.size() > s) {
+        lehmerStep(a, b, M);
+    }
+}
 
-    ans.normalize();
-    return ans;
+void BigInteger::gcdAbs(BigInteger& a, BigInteger& b, GcdMatrix* M) {
+    while (b) {
+        if (b.num.size() == 1 && !M) {
+            Limb r = a.divSmall(b.num[0]);
+            a = 0;
+            a.num[0] = gcdLimb(b.num[0], r);
+            b = 0;
+        } else if (a.num.size() > b.num.size() + 1) {
+            divisionStep(a, b, M);
+        } else if (b.num.size() >= hgcdThreshold) {
+            halfGcd(a, b, M);
+            if (b) {
+                divisionStep(a, b, M);
+            }
+        } else {
+            lehmerStep(a, b, M);
+        }
+    }
 }
 
+BigInteger gcd(const BigInteger& a, const BigInteger& b) {
+    BigInteger aa = a;
+    BigInteger bb = b;
+    aa.isNotNeg = bb.isNotNeg = true;
+    if (aa.compareMagnitude(bb) < 0) {
+        std::swap(aa, bb);
+    }
+    BigInteger::gcdAbs(aa, bb, nullptr);
+    return aa;
+}
 
-void BigInteger::addNilsToEqualizeSizes(BigInteger& a, BigInteger& b) {
-    while (a.num.size() < b.num.size()) {
-        a.num.push_back(0);
+BigInteger extendedGcd(const BigInteger& a, const BigInteger& b, BigInteger& x, BigInteger& y) {
+    BigInteger aa = a;
+    BigInteger bb = b;
+    aa.isNotNeg = bb.isNotNeg = true;
+    bool swapped = aa.compareMagnitude(bb) < 0;
+    if (swapped) {
+        std::swap(aa, bb);
     }
-    while (b.num.size() < a.num.size()) {
-        b.num.push_back(0);
+    BigInteger::GcdMatrix M;
+    BigInteger::gcdAbs(aa, bb, &M);
+    x = M.m[1][1];
+    y = M.m[0][1];
+    if (M.det < 0) {
+        x.invertSign();
+    } else {
+        y.invertSign();
     }
+    if (swapped) {
+        std::swap(x, y);
+    }
+    if (!a.isNotNeg) {
+        x.invertSign();
+    }
+    if (!b.isNotNeg) {
+        y.invertSign();
+    }
+    return aa;
 }
 
-std::pair <BigInteger, BigInteger> BigInteger::split() const {
-    BigInteger a1(0);
-    BigInteger a2(0);
-    a1.num.clear(), a2.num.clear();
+class BigInteger::MontgomeryContext {
+    friend class BigInteger;
+  private:
+    BigInteger mod;
+    BigInteger r2;
+    Limb inv;
 
-    for (size_t i = 0; i < num.size() / 2; i++) {
-        a1.num.push_back(num[i]);
-    }
-    for (size_t i = num.size() / 2; i < num.size(); i++) {
-        a2.num.push_back(num[i]);
-    }
+    BigInteger enter(const BigInteger& x) const;
+    BigInteger leave(const BigInteger& x) const;
+    void reduce(BigInteger& r, LimbVector& buffer) const;
+    void mulMod(BigInteger& r, const BigInteger& a, const BigInteger& b, LimbVector& buffer) const;
 
-    a1.normalize();
-    a2.normalize();
-    return {a1, a2};
-}
+  public:
+    explicit MontgomeryContext(const BigInteger& modulus);
 
-BigInteger& BigInteger::operator*=(const BigInteger& x) {
-    bool sig = true;
-    if (isNotNeg != x.isNotNeg) {
-        sig = false;
-    }
-    if (num.size() * x.num.size() < 100) {
-        *this = stupid_mul(*this, x);
-        this->isNotNeg = sig;
-        normalize();
-        return *this;
+    const BigInteger& modulus() const {
+        return mod;
     }
 
-    BigInteger a = *this;
-    BigInteger b = x;
+    BigInteger toMontgomery(const BigInteger& x) const;
+    BigInteger fromMontgomery(const BigInteger& x) const;
+    BigInteger multiply(const BigInteger& a, const BigInteger& b) const;
+};
 
-    addNilsToEqualizeSizes(a, b);
+class BigInteger::BarrettContext {
+    friend class BigInteger;
+  private:
+    BigInteger mod;
+    BigInteger inv;
 
-    BigInteger aa = 0;
-    aa.num.clear();
-    for (size_t i = 0; i < a.num.size() / 2; i++) {
-        aa.num.push_back(0);
+    BigInteger enter(const BigInteger& x) const {
+        return x;
     }
-    aa.num.push_back(1);
 
-    auto A = a.split();
-    BigInteger a1 = A.first;
-    BigInteger a2 = A.second;
-    auto B = b.split();
-    BigInteger b1 = B.first;
-    BigInteger b2 = B.second;
+    BigInteger leave(const BigInteger& x) const {
+        return x;
+    }
 
-    BigInteger p1 = a1;
-    p1 *= b1;
-    BigInteger p2 = a2;
-    p2 *= b2;
+    void mulMod(BigInteger& r, const BigInteger& a, const BigInteger& b, LimbVector& buffer) const;
 
-    a1 += a2, b1 += b2;
-    a1 *= b1;
-    a1 -= p1;
-    a1 -= p2;
-    a2 = stupid_mul(aa, a1);
-    aa = stupid_mul(aa, aa);
-    aa = stupid_mul(aa, p2);
-    p1 += a2;
-    p1 += aa;
+  public:
+    explicit BarrettContext(const BigInteger& modulus);
 
-    *this = p1;
-    this->isNotNeg = sig;
+    const BigInteger& modulus() const {
+        return mod;
+    }
 
-    normalize();
-    return *this;
+    BigInteger multiply(const BigInteger& a, const BigInteger& b) const;
+};
+
+BigInteger::MontgomeryContext::MontgomeryContext(const BigInteger& modulus) : mod(modulus) {
+    if (!(mod.num[0] & 1)) {
+        throw std::domain_error("MontgomeryContext: modulus must be odd");
+    }
+    mod.isNotNeg = true;
+    size_t n = mod.num.size();
+    Limb x = mod.num[0];
+    for (int i = 0; i < 5; ++i) {
+        x *= 2 - mod.num[0] * x;
+    }
+    inv = 0 - x;
+    r2.num.assign(2 * n + 1, 0);
+    r2.num.back() = 1;
+    r2 %= mod;
 }
 
-BigInteger& BigInteger::operator/=(const BigInteger& x) {
-    BigInteger a = *this;
-    BigInteger b = x;
-    BigInteger ans, c = 0;
-    if (ans.num.size() != 0)ans.num.clear();
-    if (b < 0) b = -b;
-    if (a < 0) a = -a;
-    if (c.num.size() != 0) c.num.clear();
-    c.isNotNeg = true;
-    for (int i = static_cast<int>(a.num.size()) - 1; i >= 0; --i) {
-        for (size_t j = 0; j < c.num.size() / 2; ++j) {
-            std::swap(c.num[j], c.num[c.num.size() - j - 1]);
-        }
-        c.num.push_back(a.num[i]);
-        for (size_t j = 0; j < c.num.size() / 2; ++j) {
-            std::swap(c.num[j], c.num[c.num.size() - j - 1]);
-        }
-        while (c.num.size() > 1 && c.num.back() == 0) c.num.pop_back();
-        BigInteger cur;
-        if (c >= b) {
-            int l = 1, r = base;
-            while (r - l > 1) {
-                int mid = (r + l) / 2;
-                cur = b;
-                cur *= mid;
-                if (cur <= c) l = mid;
-                else r = mid;
-            }
-            ans.num.push_back(l);
-            cur = b;
-            cur *= l;
-            c -= cur;
-        } else {
-            ans.num.push_back(0);
+void BigInteger::MontgomeryContext::reduce(BigInteger& r, LimbVector& buffer) const {
+    size_t n = mod.num.size();
+    Limb* t = buffer.data();
+    for (size_t i = 0; i < n; ++i) {
+        Limb carry = addMulLimb(t + i, mod.num.data(), n, t[i] * inv);
+        for (size_t j = i + n; carry; ++j) {
+            t[j] += carry;
+            carry = t[j] < carry;
         }
     }
-    for (size_t j = 0; j < ans.num.size() / 2; ++j) {
-        std::swap(ans.num[j], ans.num[ans.num.size() - j - 1]);
+    r.num.assign(t + n, t + 2 * n + 1);
+    r.isNotNeg = true;
+    r.normalize();
+    if (r.compareMagnitude(mod) >= 0) {
+        r -= mod;
     }
-    ans.isNotNeg = (isNotNeg == x.isNotNeg);
-    *this = ans;
-    normalize();
-    return *this;
 }
 
-BigInteger& BigInteger::operator%=(const BigInteger& x) {
-    BigInteger cur = *this;
-    cur /= x;
-    cur *= x;
-    *this -= cur;
-    return *this;
+void BigInteger::MontgomeryContext::mulMod(BigInteger& r, const BigInteger& a, const BigInteger& b,
+                                           LimbVector& buffer) const {
+    size_t n = mod.num.size();
+    size_t an = a.num.size();
+    size_t bn = b.num.size();
+    buffer.resize(2 * n + 1 + mulScratchSize(an, bn));
+    mulLimbs(buffer.data(), a.num.data(), an, b.num.data(), bn, buffer.data() + 2 * n + 1);
+    std::fill(buffer.data() + an + bn, buffer.data() + 2 * n + 1, 0);
+    reduce(r, buffer);
 }
 
-BigInteger operator ""_bi(unsigned long long x) {
-    return BigInteger(x);
+BigInteger BigInteger::MontgomeryContext::enter(const BigInteger& x) const {
+    BigInteger ans;
+    LimbVector buffer;
+    mulMod(ans, x, r2, buffer);
+    return ans;
 }
 
-BigInteger operator+(const BigInteger& a, const BigInteger& b) {
-    BigInteger x = a;
-    x += b;
-    return x;
+BigInteger BigInteger::MontgomeryContext::leave(const BigInteger& x) const {
+    size_t n = mod.num.size();
+    LimbVector buffer(2 * n + 1, 0);
+    std::copy(x.num.begin(), x.num.end(), buffer.begin());
+    BigInteger ans;
+    reduce(ans, buffer);
+    return ans;
 }
 
-BigInteger operator-(const BigInteger& a, const BigInteger& b) {
-    BigInteger x = a;
-    x -= b;
-    return x;
+BigInteger BigInteger::MontgomeryContext::toMontgomery(const BigInteger& x) const {
+    return enter(residue(x, mod));
 }
 
-BigInteger operator*(const BigInteger& a, const BigInteger& b) {
-    BigInteger x = a;
-    x *= b;
-    return x;
+BigInteger BigInteger::MontgomeryContext::fromMontgomery(const BigInteger& x) const {
+    return leave(x);
 }
 
-BigInteger operator/(const BigInteger& a, const BigInteger& b) {
-    BigInteger x = a;
-    x /= b;
-    return x;
+BigInteger BigInteger::MontgomeryContext::multiply(const BigInteger& a, const BigInteger& b) const {
+    BigInteger ans;
+    LimbVector buffer;
+    mulMod(ans, residue(a, mod), residue(b, mod), buffer);
+    return ans;
 }
 
-BigInteger operator%(const BigInteger& a, const BigInteger& b) {
-    BigInteger x = a;
-    x %= b;
-    return x;
+BigInteger::BarrettContext::BarrettContext(const BigInteger& modulus) : mod(modulus) {
+    if (!mod) {
+        throw std::domain_error("BarrettContext: modulus must be nonzero");
+    }
+    mod.isNotNeg = true;
+    if (mod.num.size() > 1) {
+        inv = reciprocal(mod);
+    }
 }
 
-std::istream& operator>>(std::istream& in, BigInteger& x) {
-    char val;
-    bool isFirst = true;
-    x.isNotNeg = true;
-    std::string cur = "";
-    bool is_null = true;
-    while ((val = in.get())) {
-        if (val == EOF) {
-            break;
+void BigInteger::BarrettContext::mulMod(BigInteger& r, const BigInteger& a, const BigInteger& b,
+                                        LimbVector&) const {
+    BigInteger product = a;
+    product *= b;
+    if (mod.num.size() == 1) {
+        r = 0;
+        r.num[0] = product.divSmall(mod.num[0]);
+        return;
+    }
+    BigInteger q;
+    divModBarrett(product, mod, inv, q, r);
+}
+
+BigInteger BigInteger::BarrettContext::multiply(const BigInteger& a, const BigInteger& b) const {
+    BigInteger ans;
+    LimbVector buffer;
+    mulMod(ans, residue(a, mod), residue(b, mod), buffer);
+    return ans;
+}
+
+BigInteger BigInteger::residue(const BigInteger& x, const BigInteger& mod) {
+    if (x.isNotNeg && x.compareMagnitude(mod) < 0) {
+        return x;
+    }
+    BigInteger a = x % mod;
+    if (!a.isNotNeg) {
+        a += mod;
+    }
+    return a;
+}
+
+template<typename Context>
+BigInteger BigInteger::slidingWindowPow(const BigInteger& base, const BigInteger& e, const Context& ctx) {
+    size_t bits = e.bitLength();
+    size_t k = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : bits > 1 ? 2 : 1;
+    LimbVector buffer;
+    std::vector<BigInteger> table(static_cast<size_t>(1) << (k - 1));
+    table[0] = base;
+    if (table.size() > 1) {
+        BigInteger square;
+        ctx.mulMod(square, base, base, buffer);
+        for (size_t i = 1; i < table.size(); ++i) {
+            ctx.mulMod(table[i], table[i - 1], square, buffer);
         }
-        if (iswspace(val)) {
-            if (!isFirst) {
-                break;
-            }
+    }
+    auto bit = [&e](size_t i) {
+        return (e.num[i / limbBits] >> (i % limbBits)) & 1;
+    };
+    BigInteger ans;
+    bool started = false;
+    for (size_t i = bits; i > 0;) {
+        if (!bit(i - 1)) {
+            ctx.mulMod(ans, ans, ans, buffer);
+            --i;
             continue;
         }
-        if (val == '-') {
-            x.isNotNeg = false;
-        } else if (val == '+') {
-            x.isNotNeg = true;
-        } else if (val != '0' || (val == '0' && !is_null)) {
-            cur += val;
-            is_null = false;
+        size_t j = i > k ? i - k : 0;
+        while (!bit(j)) {
+            ++j;
         }
-        isFirst = false;
+        size_t window = 0;
+        for (size_t t = i; t > j; --t) {
+            window = (window << 1) | bit(t - 1);
+        }
+        if (started) {
+            for (size_t t = j; t < i; ++t) {
+                ctx.mulMod(ans, ans, ans, buffer);
+            }
+            ctx.mulMod(ans, ans, table[window >> 1], buffer);
+        } else {
+            ans = table[window >> 1];
+            started = true;
+        }
+        i = j;
     }
-    if (is_null) {
-        cur = "0";
-        x.isNotNeg = true;
+    return ans;
+}
+
+template<typename Context>
+BigInteger BigInteger::powModWith(const BigInteger& e, const Context& ctx) const {
+    const BigInteger& mod = ctx.mod;
+    if (mod.num.size() == 1 && mod.num[0] == 1) {
+        return 0;
     }
-    size_t sz = cur.size();
-    if (x.num.size() != 0) {
-        x.num.clear();
+    if (!e) {
+        return 1;
     }
-    for (int i = static_cast<int>(sz); i > 0; i -= 9) {
-        int a = 0;
-        for (int j = std::max(i - 9, 0); j < i; ++j) {
-            a = a * 10 + cur[j] - '0';
+    BigInteger a = residue(*this, mod);
+    if (!e.isNotNeg) {
+        BigInteger y;
+        BigInteger inverse;
+        BigInteger g = extendedGcd(a, mod, inverse, y);
+        if (g.num.size() != 1 || g.num[0] != 1) {
+            throw std::domain_error("powMod: base is not invertible modulo m");
         }
-        x.num.push_back(a);
+        a = residue(inverse, mod);
     }
-    return in;
+    return ctx.leave(slidingWindowPow(ctx.enter(a), e, ctx));
 }
 
-std::ostream& operator<<(std::ostream& out, const BigInteger& x) {
-    std::string num = x.toString();
-    out << num;
-    return out;
+BigInteger BigInteger::powMod(const BigInteger& e, const MontgomeryContext& ctx) const {
+    return powModWith(e, ctx);
 }
 
-BigInteger gcd(const BigInteger& a, const BigInteger& b) {
-    BigInteger aa = a;
-    BigInteger bb = b;
-    while (bb) {
-        aa %= bb;
-        std::swap(aa, bb);
+BigInteger BigInteger::powMod(const BigInteger& e, const BarrettContext& ctx) const {
+    return powModWith(e, ctx);
+}
+
+BigInteger BigInteger::powMod(const BigInteger& e, const BigInteger& m) const {
+    if (!m || !m.isNotNeg) {
+        throw std::domain_error("powMod: modulus must be positive");
     }
-    return aa;
+    if (m.num[0] & 1) {
+        return powModWith(e, MontgomeryContext(m));
+    }
+    return powModWith(e, BarrettContext(m));
 }
 
 class Rational {
+    friend bool operator==(const Rational& a, const Rational& x);
   private:
+    static const size_t lazyLimbs = BIGINTEGER_RATIONAL_LAZY_LIMBS;
+    static constexpr long double approxEpsilon = std::numeric_limits<long double>::epsilon() * 64;
+
+    struct Reduced {
+        BigInteger n;
+        BigInteger m;
+    };
+
     BigInteger n = 0;
     BigInteger m = 1;
+    bool reduced = true;
+    size_t reducedLength = 2;
+    long double approx = 0;
+    long long approxExponent = 0;
+    mutable std::atomic<Reduced*> cache{nullptr};
+
+    void reduce() {
+        BigInteger curGcd = gcd(n, m);
+        if (curGcd != 1) {
+            n /= curGcd;
+            m /= curGcd;
+        }
+        reduced = true;
+        reducedLength = n.getLength() + m.getLength();
+    }
+
+    // Const members never modify n and m: the reduced fraction of a lazy
+    // value is computed once and published in cache, which the next
+    // mutation adopts as its new n and m.
+    template<typename F>
+    auto withReduced(F f) const {
+        if (reduced) {
+            return f(n, m);
+        }
+        Reduced* cur = cache.load(std::memory_order_acquire);
+        if (!cur) {
+            BigInteger curGcd = gcd(n, m);
+            Reduced* fresh = new Reduced{n / curGcd, m / curGcd};
+            if (cache.compare_exchange_strong(cur, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                cur = fresh;
+            } else {
+                delete fresh;
+            }
+        }
+        return f(cur->n, cur->m);
+    }
+
+    void adopt() {
+        if (Reduced* cur = cache.exchange(nullptr, std::memory_order_relaxed)) {
+            n = std::move(cur->n);
+            m = std::move(cur->m);
+            reduced = true;
+            reducedLength = n.getLength() + m.getLength();
+            delete cur;
+        }
+    }
+
+    void assign(const Rational& x) {
+        const Reduced* cur = x.cache.load(std::memory_order_acquire);
+        n = cur ? cur->n : x.n;
+        m = cur ? cur->m : x.m;
+        reduced = cur || x.reduced;
+        reducedLength = cur ? n.getLength() + m.getLength() : x.reducedLength;
+        approx = x.approx;
+        approxExponent = x.approxExponent;
+    }
+
+    void approximate() {
+        long long e1;
+        long long e2;
+        approx = n.toDouble(e1) / m.toDouble(e2);
+        approxExponent = e1 - e2;
+        if (approx >= 1 || approx <= -1) {
+            approx /= 2;
+            ++approxExponent;
+        }
+    }
 
     void normalize() {
         if (!m.getSign()) {
             n.invertSign();
             m.invertSign();
         }
-        bool f = false;
-        if (!n.getSign()) {
-            f = true;
-            n.invertSign();
+        if (!n) {
+            m = 1;
+            reduced = true;
+            reducedLength = 2;
+            return;
         }
-        BigInteger curGcd = gcd(n, m);
-        n /= curGcd;
-        m /= curGcd;
-        if (f) {
-            n.invertSign();
+        reduced = false;
+        if (lazyLimbs == 0 || n.getLength() + m.getLength() > reducedLength + lazyLimbs) {
+            reduce();
         }
+        approximate();
     }
 
   public:
     Rational() : n(0), m(1) {}
 
-    Rational(const BigInteger x) : n(x), m(1) {}
+    Rational(BigInteger x) : n(std::move(x)), m(1) {
+        approximate();
+    }
+
+    Rational (const int& x) : n(x), m(1) {
+        approximate();
+    }
+
+    Rational (BigInteger x, BigInteger y) : n(std::move(x)), m(std::move(y)) {
+        normalize();
+    }
+
+    Rational(const Rational& x) {
+        assign(x);
+    }
+
+    Rational(Rational&& x) noexcept
+        : n(std::move(x.n)), m(std::move(x.m)), reduced(x.reduced), reducedLength(x.reducedLength),
+          approx(x.approx), approxExponent(x.approxExponent), cache(x.cache.exchange(nullptr)) {}
+
+    Rational& operator=(const Rational& x) {
+        if (this != &x) {
+            delete cache.exchange(nullptr);
+            assign(x);
+        }
+        return *this;
+    }
 
-    Rational (const int& x) : n(x), m(1) {}
+    Rational& operator=(Rational&& x) noexcept {
+        if (this != &x) {
+            n = std::move(x.n);
+            m = std::move(x.m);
+            reduced = x.reduced;
+            reducedLength = x.reducedLength;
+            approx = x.approx;
+            approxExponent = x.approxExponent;
+            delete cache.exchange(x.cache.exchange(nullptr));
+        }
+        return *this;
+    }
 
-    Rational (const BigInteger x, const BigInteger y) : n(x), m(y) {}
+    ~Rational() {
+        delete cache.load(std::memory_order_relaxed);
+    }
 
     BigInteger getn() const {
-        return n;
+        return withReduced([](const BigInteger& a, const BigInteger&) {
+            return a;
+        });
     }
 
     BigInteger getm() const {
-        return m;
+        return withReduced([](const BigInteger&, const BigInteger& b) {
+            return b;
+        });
     }
 
     size_t getNsize() const {
-        return n.getLength();
+        return withReduced([](const BigInteger& a, const BigInteger&) {
+            return a.getLength();
+        });
     }
 
     size_t getMsize() const {
-        return m.getLength();
+        return withReduced([](const BigInteger&, const BigInteger& b) {
+            return b.getLength();
+        });
     }
 
     Rational operator-() const {
         Rational ans = *this;
         ans.n.invertSign();
+        ans.approx = -ans.approx;
         return ans;
     }
 
     std::string toString() const {
-        std::string cur = "";
-        cur = n.toString();
-        if (m == 1) {
+        return withReduced([](const BigInteger& a, const BigInteger& b) {
+            std::string cur = "";
+            cur = a.toString();
+            if (b == 1) {
+                return cur;
+            }
+            cur += '/';
+            cur += b.toString();
             return cur;
-        }
-        cur += '/';
-        cur += m.toString();
-        return cur;
+        });
     }
 
     Rational& operator+=(const Rational& x) {
-        n = n * x.m + x.n * m;
+        adopt();
+        BigInteger cur = x.n * m;
+        n *= x.m;
+        n += cur;
         m *= x.m;
         normalize();
         return *this;
     }
 
     Rational& operator-=(const Rational& x) {
-        n = n * x.m - x.n * m;
+        adopt();
+        BigInteger cur = x.n * m;
+        n *= x.m;
+        n -= cur;
         m *= x.m;
         normalize();
         return *this;
     }
 
     Rational& operator*=(const Rational& x) {
-        BigInteger nul(0);
-        if (x.getn() == nul || this->getn() == nul) {
+        adopt();
+        if (!x.n || !n) {
             return *this = static_cast<Rational>(0);
         }
         n *= x.n;
@@ -583,59 +3358,168 @@ class Rational {
     }
 
     Rational& operator/=(const Rational& x) {
+        adopt();
         n *= x.m;
         m *= x.n;
         normalize();
         return *this;
     }
 
+    size_t serializedSize() const {
+        return withReduced([](const BigInteger& a, const BigInteger& b) {
+            return a.serializedSize() + b.serializedSize();
+        });
+    }
+
+    std::byte* serialize(std::span<std::byte> out) const {
+        return withReduced([out](const BigInteger& a, const BigInteger& b) -> std::byte* {
+            std::byte* mid = a.serialize(out);
+            if (!mid) {
+                return nullptr;
+            }
+            return b.serialize(std::span<std::byte>(mid, out.data() + out.size()));
+        });
+    }
+
+    static const std::byte* deserialize(std::span<const std::byte> in, Rational& x) {
+        BigInteger a;
+        BigInteger b;
+        const std::byte* mid = BigInteger::deserialize(in, a);
+        if (!mid) {
+            return nullptr;
+        }
+        const std::byte* last = BigInteger::deserialize(std::span<const std::byte>(mid, in.data() + in.size()), b);
+        if (!last || !b) {
+            return nullptr;
+        }
+        x = Rational(std::move(a), std::move(b));
+        return last;
+    }
+
     std::string asDecimal(size_t precision = 0) const {
         BigInteger a = n;
-        std::string ans = "";
-        bool isNeg = false;
-        if (a < 0) {
+        bool isNeg = !a.getSign();
+        if (isNeg) {
             a.invertSign();
-            isNeg = true;
         }
-        for (size_t i = 0; i < precision + 1; ++i) {
-            a *= 10;
+        a *= BigInteger::powerOfTen(precision);
+        BigInteger r;
+        a.divmod(m, a, r);
+        r += r;
+        if (r >= m) {
+            ++a;
         }
-        a /= m;
-        if (a % 10 >= 5) {
-            a += 5;
+        std::string ans(a.maxChars() + precision + 3, '0');
+        char* first = ans.data();
+        if (isNeg && (precision != 0 || a)) {
+            *first++ = '-';
         }
-        a /= 10;
-        std::string s = a.toString();
-        if (precision == 0) {
-            if (isNeg && a != 0) {
-                s = "-" + s;
-            }
-            return s;
+        char* last = a.toChars(first + precision + 2, ans.data() + ans.size()).ptr;
+        char* start = std::min(first + precision + 2, last - precision - 1);
+        size_t wholeLength = last - start - precision;
+        std::memmove(first, start, wholeLength);
+        first += wholeLength;
+        if (precision != 0) {
+            *first++ = '.';
+            std::memmove(first, last - precision, precision);
+            first += precision;
+        }
+        ans.resize(first - ans.data());
+        return ans;
+    }
+
+    void writeDecimal(std::ostream& out, size_t precision, size_t chunkDigits = 4096) const {
+        BigInteger pending = n;
+        bool isNeg = !pending.getSign();
+        if (isNeg) {
+            pending.invertSign();
         }
-        std::string cur = "";
-        for (int i = 0; i < static_cast<int>(precision) - static_cast<int>(s.size()) + 1; ++i) {
-            cur += "0";
+        BigInteger r;
+        pending.divmod(m, pending, r);
+        if (isNeg && precision != 0) {
+            out << '-';
         }
-        s = cur + s;
-        ans = "";
-        for (size_t i = 0; i < s.size(); ++i) {
-            if (s[i] != 0) {
-                if (isNeg) {
-                    ans += "-";
+        size_t pendingDigits = 0;
+        size_t nines = 0;
+        auto emit = [&out](const BigInteger& x, size_t digits) {
+            std::string cur = x.toString();
+            if (digits == 0) {
+                out << cur;
+                return;
+            }
+            for (size_t i = cur.size(); i < digits; ++i) {
+                out << '0';
+            }
+            out << cur;
+        };
+        BigInteger scale;
+        BigInteger maxChunk;
+        BigInteger q;
+        size_t scaleDigits = 0;
+        for (size_t done = 0; done < precision;) {
+            size_t cur = std::min(chunkDigits, precision - done);
+            if (cur != scaleDigits) {
+                scale = BigInteger::powerOfTen(cur);
+                maxChunk = scale - 1;
+                scaleDigits = cur;
+            }
+            r *= scale;
+            r.divmod(m, q, r);
+            if (q == maxChunk) {
+                nines += cur;
+            } else {
+                emit(pending, pendingDigits);
+                if (pendingDigits == 0) {
+                    out << '.';
                 }
-                break;
+                out << std::string(nines, '9');
+                nines = 0;
+                std::swap(pending, q);
+                pendingDigits = cur;
             }
+            done += cur;
         }
-        for (size_t i = 0; i < s.size(); ++i) {
-            if (s.size() - i == precision) {
-                ans += ".";
-            }
-            ans += s[i];
+        r += r;
+        bool roundUp = r >= m;
+        if (roundUp) {
+            ++pending;
         }
-        return ans;
+        if (isNeg && precision == 0 && pending) {
+            out << '-';
+        }
+        emit(pending, pendingDigits);
+        if (pendingDigits == 0 && precision != 0) {
+            out << '.';
+        }
+        out << std::string(nines, roundUp ? '0' : '9');
+    }
+
+    int compare(const Rational& x) const {
+        int s = !n ? 0 : (n.getSign() ? 1 : -1);
+        int t = !x.n ? 0 : (x.n.getSign() ? 1 : -1);
+        if (s != t) {
+            return s < t ? -1 : 1;
+        }
+        if (s == 0) {
+            return 0;
+        }
+        long long d = approxExponent - x.approxExponent;
+        if (d > 1 || d < -1) {
+            return d > 0 ? s : -s;
+        }
+        long double diff = std::ldexp(approx, static_cast<int>(d)) - x.approx;
+        if (std::fabs(diff) > approxEpsilon * std::fabs(x.approx)) {
+            return diff > 0 ? 1 : -1;
+        }
+        return (n * x.m).compare(m * x.n);
     }
+
     explicit operator double() const {
-        return std::stod(asDecimal(10));
+        if (!n) {
+            return 0;
+        }
+        long long e = std::clamp(approxExponent, -100000LL, 100000LL);
+        return static_cast<double>(std::ldexp(approx, static_cast<int>(e)));
     }
 };
 
@@ -647,13 +3531,17 @@ std::ostream& operator<<(std::ostream& out, const Rational& x) {
 
 std::istream& operator>>(std::istream& in, Rational& x) {
     BigInteger y;
-    in >> y;
-    x = static_cast<Rational>(y);
+    if (in >> y) {
+        x = static_cast<Rational>(y);
+    }
     return in;
 }
 
 bool operator==(const Rational& a, const Rational& x) {
-    return a.getn() == x.getn() && a.getm() == x.getm();
+    if (a.reduced && x.reduced) {
+        return a.n == x.n && a.m == x.m;
+    }
+    return a.compare(x) == 0;
 }
 
 bool operator!=(const Rational& a, const Rational& x) {
@@ -661,7 +3549,7 @@ bool operator!=(const Rational& a, const Rational& x) {
 }
 
 bool operator<(const Rational& a, const Rational& x) {
-    return a.getn() * x.getm() < a.getm() * x.getn();
+    return a.compare(x) < 0;
 }
 
 bool operator<=(const Rational& a, const Rational& x) {
@@ -682,20 +3570,60 @@ Rational operator+(const Rational& a, const Rational& b) {
     return ans;
 }
 
+Rational operator+(Rational&& a, const Rational& b) {
+    a += b;
+    return std::move(a);
+}
+
+Rational operator+(const Rational& a, Rational&& b) {
+    b += a;
+    return std::move(b);
+}
+
+Rational operator+(Rational&& a, Rational&& b) {
+    a += b;
+    return std::move(a);
+}
+
 Rational operator-(const Rational& a, const Rational& b) {
     Rational ans = a;
     ans -= b;
     return ans;
 }
 
+Rational operator-(Rational&& a, const Rational& b) {
+    a -= b;
+    return std::move(a);
+}
+
 Rational operator*(const Rational& a, const Rational& b) {
     Rational ans = a;
     ans *= b;
     return ans;
 }
 
+Rational operator*(Rational&& a, const Rational& b) {
+    a *= b;
+    return std::move(a);
+}
+
+Rational operator*(const Rational& a, Rational&& b) {
+    b *= a;
+    return std::move(b);
+}
+
+Rational operator*(Rational&& a, Rational&& b) {
+    a *= b;
+    return std::move(a);
+}
+
 Rational operator/(const Rational& a, const Rational& b) {
     Rational ans = a;
     ans /= b;
     return ans;
 }
+
+Rational operator/(Rational&& a, const Rational& b) {
+    a /= b;
+    return std::move(a);
+}
@@ -1,33 +1,35 @@
+#pragma once
+
 #include <iostream>
 #include <math.h>
 #include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <mutex>
+#include <span>
+#include <stdexcept>
 #include <vector>
 
 namespace {
 
-template<unsigned N, unsigned D>
-struct is_prime_helper {
-    static const bool value = N % D == 0 ? false :
-        is_prime_helper<N, D - 1 - (D & 1)>::value;
-};
-
-template<unsigned N>
-struct is_prime_helper<N, 1> {
-    static const bool value = true;
-};
-
-template<unsigned N>
-struct is_prime_helper<N, 0> {
-    static const bool value = true;
-};
+constexpr bool is_prime_helper(unsigned n) {
+    if (n <= 1 || (n > 2 && !(n & 1))) {
+        return false;
+    }
+    for (unsigned d = 3; d <= n / d; d += 2) {
+        if (n % d == 0) {
+            return false;
+        }
+    }
+    return true;
+}
 
 } // namespace helpers
 
 
 template<unsigned N>
 struct is_prime {
-    static const bool value = (N <= 1 || (N > 2 && !(N & 1))) ? false :
-        is_prime_helper<N, static_cast<unsigned>(std::floor(sqrt(N) + 0.5))>::value;
+    static const bool value = is_prime_helper(N);
 };
 
 template<unsigned N>
@@ -36,94 +38,38 @@ static const bool is_prime_v = is_prime<N>::value;
 
 namespace {
 
-template<unsigned X, unsigned N>
-struct check_deg {
-    static const bool value = N % X == 0 ? check_deg<X, N / X>::value : false;
-};
-
-template<unsigned X>
-struct check_deg<X, X> {
-    static const bool value = true;
-};
-
-template<unsigned N>
-struct check_deg<1, N> {
-    static const bool value = false;
-};
-
-template<unsigned N>
-struct check_deg<0, N> {
-    static const bool value = false;
-};
-
-template<unsigned X>
-struct check_deg<X, 0> {
-    static const bool value = false;
-};
-
-template<>
-struct check_deg<1, 1> {
-    static const bool value = false;
-};
-
-template<>
-struct check_deg<0, 0> {
-    static const bool value = false;
-};
-
-template<unsigned N, unsigned P>
-struct find_min_del {
-    static const unsigned value = find_min_del<N, P - 1 - (P & 1)>::value == 0 ?
-        (N % P == 0 ? P : 0) : find_min_del<N, P - 1 - (P & 1)>::value;
-};
-
-template<unsigned N>
-struct find_min_del<N, 1> {
-    static const unsigned value = 0;
-};
-
-template<unsigned N>
-struct find_min_del<N, 0> {
-    static const unsigned value = 0;
-};
-
-template<unsigned N>
-struct is_deg_of_simple {
-    static const bool value = is_prime_v<N> ||
-        check_deg<find_min_del<N, static_cast<unsigned>(std::floor(sqrt(N) + 0.5))>::value, N>::value;
-};
+constexpr bool check_deg(unsigned x, unsigned n) {
+    while (n % x == 0) {
+        n /= x;
+    }
+    return n == 1;
+}
 
-template<>
-struct is_deg_of_simple<2> {
-    static const bool value = false;
-};
+constexpr unsigned find_min_del(unsigned n) {
+    for (unsigned d = 3; d <= n / d; d += 2) {
+        if (n % d == 0) {
+            return d;
+        }
+    }
+    return n;
+}
 
-template<>
-struct is_deg_of_simple<1> {
-    static const bool value = false;
-};
+constexpr bool is_deg_of_simple(unsigned n) {
+    return n > 2 && (n & 1) && check_deg(find_min_del(n), n);
+}
 
-template<>
-struct is_deg_of_simple<0> {
-    static const bool value = false;
-};
+constexpr bool has_primitive_root_helper(uint32_t n) {
+    if (n == 2 || n == 4) {
+        return true;
+    }
+    return (n % 4 == 0) ? false : (n % 4 == 2 ? is_deg_of_simple(n / 2) : is_deg_of_simple(n));
+}
 
 } // namespace helpers
 
 template<unsigned N>
 struct has_primitive_root {
-    static const bool value = (N % 4 == 0) ? false :
-        (N % 4 == 2 ? is_deg_of_simple<N / 2>::value : is_deg_of_simple<N>::value);
-};
-
-template<>
-struct has_primitive_root<2> {
-    static const bool value = true;
-};
-
-template<>
-struct has_primitive_root<4> {
-    static const bool value = true;
+    static const bool value = has_primitive_root_helper(N);
 };
 
 template<unsigned N>
@@ -156,59 +102,147 @@ int gcd(int a, int b) {
 }
 } // namespace details
 
+namespace {
+
+constexpr uint32_t montgomery_inverse(uint32_t mod) {
+    uint32_t inv = mod;
+    for (int i = 0; i < 4; ++i) {
+        inv *= 2 - mod * inv;
+    }
+    return inv;
+}
+
+constexpr uint32_t montgomery_r2(uint32_t mod) {
+    uint64_t r = (uint64_t(1) << 32) % mod;
+    return static_cast<uint32_t>(r * r % mod);
+}
+
+constexpr uint32_t montgomery_reduce(uint64_t t, uint32_t mod, uint32_t inv) {
+    uint32_t q = static_cast<uint32_t>(t) * inv;
+    uint32_t hi = static_cast<uint32_t>(t >> 32);
+    uint32_t sub = static_cast<uint32_t>((static_cast<uint64_t>(q) * mod) >> 32);
+    return hi >= sub ? hi - sub : hi - sub + mod;
+}
+
+constexpr uint32_t barrett_reduce(uint64_t t, uint32_t mod, uint64_t factor) {
+    uint64_t q = static_cast<uint64_t>((static_cast<unsigned __int128>(t) * factor) >> 64);
+    uint64_t r = t - q * mod;
+    return static_cast<uint32_t>(r >= mod ? r - mod : r);
+}
+
+} // namespace helpers
+
+template<unsigned Mod, bool Odd = (Mod % 2 == 1)>
+struct residue_reduction;
+
+template<unsigned Mod>
+struct residue_reduction<Mod, true> {
+    static constexpr uint32_t modInverse = montgomery_inverse(Mod);
+    static constexpr uint32_t r2 = montgomery_r2(Mod);
+
+    static constexpr uint32_t to(uint32_t x) {
+        return montgomery_reduce(static_cast<uint64_t>(x) * r2, Mod, modInverse);
+    }
+
+    static constexpr uint32_t from(uint32_t x) {
+        return montgomery_reduce(x, Mod, modInverse);
+    }
+
+    static constexpr uint32_t mul(uint32_t a, uint32_t b) {
+        return montgomery_reduce(static_cast<uint64_t>(a) * b, Mod, modInverse);
+    }
+};
+
+template<unsigned Mod>
+struct residue_reduction<Mod, false> {
+    static constexpr uint64_t factor = ~uint64_t(0) / Mod;
+
+    static constexpr uint32_t to(uint32_t x) {
+        return x;
+    }
+
+    static constexpr uint32_t from(uint32_t x) {
+        return x;
+    }
+
+    static constexpr uint32_t mul(uint32_t a, uint32_t b) {
+        return barrett_reduce(static_cast<uint64_t>(a) * b, Mod, factor);
+    }
+};
+
 template<unsigned Mod>
 class Residue {
   private:
-    long long x;
+    using reduction = residue_reduction<Mod>;
+
+    uint32_t x;
+
+    static const size_t tableLimit = size_t(1) << 21;
+
+    struct Tables;
+    static Tables& tables();
+    static Residue lookup(std::vector<Residue> Tables::* table, unsigned n);
+    static Residue choose(unsigned n, unsigned k);
+
+    static constexpr Residue fromUnsigned(uint32_t v) {
+        Residue ans;
+        ans.x = reduction::to(v % Mod);
+        return ans;
+    }
 
   public:
     Residue() = default;
 
-    explicit Residue(int xx) {
-        if (xx >= 0) {
-            x = xx % Mod;
-        } else {
-            x = (Mod - (-xx) % Mod) % Mod;
-        }
+    constexpr explicit Residue(int xx) : x(0) {
+        long long y = xx % static_cast<long long>(Mod);
+        x = reduction::to(static_cast<uint32_t>(y < 0 ? y + Mod : y));
     }
 
-    explicit operator int() const {
-        return x;
+    constexpr explicit operator int() const {
+        return reduction::from(x);
     }
 
-    Residue& operator+=(const Residue other) {
-        x = (x + other.x) % Mod;
+    constexpr Residue& operator+=(const Residue other) {
+        uint64_t sum = static_cast<uint64_t>(x) + other.x;
+        x = static_cast<uint32_t>(sum >= Mod ? sum - Mod : sum);
         return *this;
     }
 
-    Residue& operator-=(const Residue other) {
-        x = (x - other.x + Mod) % Mod;
+    constexpr Residue& operator-=(const Residue other) {
+        uint32_t diff = x - other.x;
+        x = x >= other.x ? diff : diff + Mod;
         return *this;
     }
 
-    Residue& operator*=(const Residue other) {
-        x = (static_cast<long long>(x) * other.x) % Mod;
+    constexpr Residue& operator*=(const Residue other) {
+        x = reduction::mul(x, other.x);
         return *this;
     }
 
-    bool operator==(const Residue other) {
+    constexpr bool operator==(const Residue other) const {
         return x == other.x;
     }
 
-    Residue pow(unsigned p) const {
-        if (p == 0) {
-            return static_cast<Residue>(1);
-        }
-        if (p % 2 == 1) {
-            return *this * pow(p - 1);
+    constexpr bool operator!=(const Residue other) const {
+        return !(x == other.x);
+    }
+
+    constexpr Residue pow(unsigned p) const {
+        Residue ans(1);
+        Residue cur = *this;
+        while (p > 0) {
+            if (p & 1) {
+                ans *= cur;
+            }
+            cur *= cur;
+            p >>= 1;
         }
-        Residue c = pow(p / 2);
-        return c * c;
+        return ans;
     }
 
-    Residue getInverse() const;
+    constexpr Residue getInverse() const;
 
-    Residue& operator/=(const Residue other) {
+    constexpr Residue& operator/=(const Residue other) {
         return *this *= other.getInverse();
     }
 
@@ -229,31 +263,52 @@ class Residue {
     }
 
     static Residue getPrimitiveRoot();
+
+    static void reserveTables(unsigned n);
+    static Residue factorial(unsigned n);
+    static Residue inverseFactorial(unsigned n);
+    static Residue inverse(unsigned n);
+    static Residue binomial(unsigned n, unsigned k);
 };
 
 template<unsigned Mod>
-Residue<Mod> operator+(const Residue<Mod> a, const Residue<Mod> b) {
+std::ostream& operator<<(std::ostream& out, const Residue<Mod>& x) {
+    long long y = static_cast<int>(x);
+    out << y;
+    return out;
+}
+
+template<unsigned Mod>
+std::istream& operator>>(std::istream& in, Residue<Mod>& x) {
+    long long y;
+    in >> y;
+    x = static_cast<Residue<Mod>>(y);
+    return in;
+}
+
+template<unsigned Mod>
+constexpr Residue<Mod> operator+(const Residue<Mod> a, const Residue<Mod> b) {
     Residue<Mod> ans = a;
     ans += b;
     return ans;
 }
 
 template<unsigned Mod>
-Residue<Mod> operator-(const Residue<Mod> a, const Residue<Mod> b) {
+constexpr Residue<Mod> operator-(const Residue<Mod> a, const Residue<Mod> b) {
     Residue<Mod> ans = a;
     ans -= b;
     return ans;
 }
 
 template<unsigned Mod>
-Residue<Mod> operator*(const Residue<Mod> a, const Residue<Mod> b) {
+constexpr Residue<Mod> operator*(const Residue<Mod> a, const Residue<Mod> b) {
     Residue<Mod> ans = a;
     ans *= b;
     return ans;
 }
 
 template<unsigned Mod>
-Residue<Mod> operator/(const Residue<Mod> a, const Residue<Mod> b) {
+constexpr Residue<Mod> operator/(const Residue<Mod> a, const Residue<Mod> b) {
     Residue<Mod> ans = a;
     ans /= b;
     return ans;
@@ -266,12 +321,37 @@ void crashIfFalse(bool flag) {
 };
 
 template<unsigned Mod>
-Residue<Mod> Residue<Mod>::getInverse() const {
-    crashIfFalse(is_prime_v<Mod>);
+constexpr Residue<Mod> Residue<Mod>::getInverse() const {
+    static_assert(is_prime_v<Mod>);
     return this->pow(Mod - 2);
 }
 
 
+template<typename R>
+void prefixBatchInverse(std::span<R> a, const R zero, R acc) {
+    std::vector<R> prefix(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        prefix[i] = acc;
+        if (a[i] != zero) {
+            acc *= a[i];
+        }
+    }
+    acc = acc.getInverse();
+    for (size_t i = a.size(); i > 0; --i) {
+        if (a[i - 1] == zero) {
+            continue;
+        }
+        R cur = a[i - 1];
+        a[i - 1] = acc * prefix[i - 1];
+        acc *= cur;
+    }
+}
+
+template<unsigned Mod>
+void batchInverse(std::span<Residue<Mod>> a) {
+    prefixBatchInverse(a, Residue<Mod>(0), Residue<Mod>(1));
+}
+
 template<unsigned Mod>
 Residue<Mod> Residue<Mod>::getPrimitiveRoot() {
     crashIfFalse(has_primitive_root_v<Mod>);
@@ -308,3 +388,377 @@ Residue<Mod> Residue<Mod>::getPrimitiveRoot() {
         }
     }
 }
+
+template<unsigned Mod>
+struct Residue<Mod>::Tables {
+    std::mutex mutex;
+    std::vector<Residue> fact{Residue(1)};
+    std::vector<Residue> invFact{Residue(1)};
+    std::vector<Residue> inv{Residue(0)};
+
+    void grow(size_t n) {
+        static_assert(is_prime_v<Mod>);
+        size_t old = fact.size();
+        n = std::min<size_t>({std::max(n + 1, 2 * old), Mod, tableLimit});
+        if (n <= old) {
+            return;
+        }
+        fact.resize(n);
+        invFact.resize(n);
+        inv.resize(n);
+        for (size_t i = old; i < n; ++i) {
+            fact[i] = fact[i - 1] * fromUnsigned(i);
+        }
+        invFact[n - 1] = fact[n - 1].getInverse();
+        for (size_t i = n - 1; i > old; --i) {
+            invFact[i - 1] = invFact[i] * fromUnsigned(i);
+        }
+        for (size_t i = std::max<size_t>(old, 1); i < n; ++i) {
+            inv[i] = invFact[i] * fact[i - 1];
+        }
+    }
+};
+
+template<unsigned Mod>
+typename Residue<Mod>::Tables& Residue<Mod>::tables() {
+    static Tables table;
+    return table;
+}
+
+template<unsigned Mod>
+Residue<Mod> Residue<Mod>::lookup(std::vector<Residue> Tables::* table, unsigned n) {
+    Tables& t = tables();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    if (n >= t.fact.size()) {
+        t.grow(n);
+    }
+    return (t.*table)[n];
+}
+
+template<unsigned Mod>
+void Residue<Mod>::reserveTables(unsigned n) {
+    lookup(&Tables::fact, std::min<size_t>({n, Mod - 1, tableLimit - 1}));
+}
+
+template<unsigned Mod>
+Residue<Mod> Residue<Mod>::factorial(unsigned n) {
+    if (n >= Mod) {
+        return Residue(0);
+    }
+    if (n < tableLimit) {
+        return lookup(&Tables::fact, n);
+    }
+    Residue ans = lookup(&Tables::fact, tableLimit - 1);
+    for (size_t i = tableLimit; i <= n; ++i) {
+        ans *= fromUnsigned(i);
+    }
+    return ans;
+}
+
+template<unsigned Mod>
+Residue<Mod> Residue<Mod>::inverseFactorial(unsigned n) {
+    if (n >= Mod) {
+        return Residue(0);
+    }
+    if (n < tableLimit) {
+        return lookup(&Tables::invFact, n);
+    }
+    return factorial(n).getInverse();
+}
+
+template<unsigned Mod>
+Residue<Mod> Residue<Mod>::inverse(unsigned n) {
+    n %= Mod;
+    if (n < tableLimit) {
+        return lookup(&Tables::inv, n);
+    }
+    return fromUnsigned(n).getInverse();
+}
+
+template<unsigned Mod>
+Residue<Mod> Residue<Mod>::choose(unsigned n, unsigned k) {
+    if (n < tableLimit) {
+        return lookup(&Tables::fact, n) * lookup(&Tables::invFact, k) * lookup(&Tables::invFact, n - k);
+    }
+    k = std::min(k, n - k);
+    Residue ans(1);
+    for (unsigned i = 0; i < k; ++i) {
+        ans *= fromUnsigned(n - i);
+    }
+    return ans * inverseFactorial(k);
+}
+
+template<unsigned Mod>
+Residue<Mod> Residue<Mod>::binomial(unsigned n, unsigned k) {
+    Residue ans(1);
+    while (k > 0) {
+        unsigned nn = n % Mod;
+        unsigned kk = k % Mod;
+        if (kk > nn) {
+            return Residue(0);
+        }
+        ans *= choose(nn, kk);
+        n /= Mod;
+        k /= Mod;
+    }
+    return ans;
+}
+
+class ModContext {
+  private:
+    uint32_t mod;
+    bool odd;
+    uint32_t modInverse;
+    uint32_t r2;
+    uint64_t factor;
+
+    static uint32_t checkedModulus(uint32_t m) {
+        if (m == 0) {
+            throw std::invalid_argument("ModContext: modulus must be nonzero");
+        }
+        return m;
+    }
+
+  public:
+    // A modulus of 1 is allowed and gives the zero ring: every value is 0.
+    explicit ModContext(uint32_t m) : mod(checkedModulus(m)), odd(m % 2 == 1), modInverse(montgomery_inverse(m)),
+                                      r2(odd ? montgomery_r2(m) : 0), factor(~uint64_t(0) / m) {}
+
+    uint32_t modulus() const {
+        return mod;
+    }
+
+    uint32_t to(uint32_t x) const {
+        return odd ? montgomery_reduce(static_cast<uint64_t>(x) * r2, mod, modInverse) : x;
+    }
+
+    uint32_t from(uint32_t x) const {
+        return odd ? montgomery_reduce(x, mod, modInverse) : x;
+    }
+
+    uint32_t mul(uint32_t a, uint32_t b) const {
+        uint64_t t = static_cast<uint64_t>(a) * b;
+        return odd ? montgomery_reduce(t, mod, modInverse) : barrett_reduce(t, mod, factor);
+    }
+
+    static const ModContext*& current() {
+        thread_local const ModContext* context = nullptr;
+        return context;
+    }
+
+    static const ModContext& scoped() {
+        if (!current()) {
+            throw std::logic_error("DynResidue: no ModContext::Scope is active");
+        }
+        return *current();
+    }
+
+    class Scope {
+      private:
+        const ModContext* previous;
+
+      public:
+        explicit Scope(const ModContext& context) : previous(current()) {
+            current() = &context;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        ~Scope() {
+            current() = previous;
+        }
+    };
+};
+
+class DynResidue {
+  private:
+    const ModContext* ctx;
+    uint32_t x;
+
+  public:
+    DynResidue() : ctx(&ModContext::scoped()), x(0) {}
+
+    explicit DynResidue(int xx) : DynResidue(xx, ModContext::scoped()) {}
+
+    DynResidue(long long xx, const ModContext& context) : ctx(&context) {
+        long long y = xx % static_cast<long long>(ctx->modulus());
+        x = ctx->to(static_cast<uint32_t>(y < 0 ? y + ctx->modulus() : y));
+    }
+
+    const ModContext& context() const {
+        return *ctx;
+    }
+
+    uint32_t value() const {
+        return ctx->from(x);
+    }
+
+    explicit operator int() const {
+        return value();
+    }
+
+    DynResidue& operator+=(const DynResidue other) {
+        uint64_t sum = static_cast<uint64_t>(x) + other.x;
+        x = static_cast<uint32_t>(sum >= ctx->modulus() ? sum - ctx->modulus() : sum);
+        return *this;
+    }
+
+    DynResidue& operator-=(const DynResidue other) {
+        uint32_t diff = x - other.x;
+        x = x >= other.x ? diff : diff + ctx->modulus();
+        return *this;
+    }
+
+    DynResidue& operator*=(const DynResidue other) {
+        x = ctx->mul(x, other.x);
+        return *this;
+    }
+
+    bool operator==(const DynResidue other) const {
+        return ctx->modulus() == other.ctx->modulus() && x == other.x;
+    }
+
+    bool operator!=(const DynResidue other) const {
+        return !(*this == other);
+    }
+
+    DynResidue pow(unsigned long long p) const {
+        DynResidue ans(1, *ctx);
+        DynResidue cur = *this;
+        while (p > 0) {
+            if (p & 1) {
+                ans *= cur;
+            }
+            cur *= cur;
+            p >>= 1;
+        }
+        return ans;
+    }
+
+    DynResidue getInverse() const;
+
+    DynResidue& operator/=(const DynResidue other) {
+        return *this *= other.getInverse();
+    }
+
+    long long order() const;
+
+    static DynResidue getPrimitiveRoot(const ModContext& context);
+
+    static DynResidue getPrimitiveRoot() {
+        return getPrimitiveRoot(ModContext::scoped());
+    }
+};
+
+std::ostream& operator<<(std::ostream& out, const DynResidue& x) {
+    out << x.value();
+    return out;
+}
+
+std::istream& operator>>(std::istream& in, DynResidue& x) {
+    long long y;
+    in >> y;
+    x = DynResidue(y, ModContext::scoped());
+    return in;
+}
+
+DynResidue operator+(const DynResidue a, const DynResidue b) {
+    DynResidue ans = a;
+    ans += b;
+    return ans;
+}
+
+DynResidue operator-(const DynResidue a, const DynResidue b) {
+    DynResidue ans = a;
+    ans -= b;
+    return ans;
+}
+
+DynResidue operator*(const DynResidue a, const DynResidue b) {
+    DynResidue ans = a;
+    ans *= b;
+    return ans;
+}
+
+DynResidue operator/(const DynResidue a, const DynResidue b) {
+    DynResidue ans = a;
+    ans /= b;
+    return ans;
+}
+
+DynResidue DynResidue::getInverse() const {
+    long long a = value();
+    long long b = ctx->modulus();
+    long long u = 1;
+    long long v = 0;
+    while (b) {
+        long long q = a / b;
+        a -= q * b;
+        std::swap(a, b);
+        u -= q * v;
+        std::swap(u, v);
+    }
+    return DynResidue(a == 1 ? u : 0, *ctx);
+}
+
+long long DynResidue::order() const {
+    long long ph = phi(ctx->modulus());
+    long long ans = ctx->modulus();
+    const DynResidue one(1, *ctx);
+    for (long long i = 1; i * i <= ph; ++i) {
+        if (ph % i == 0) {
+            if (pow(i) == one) {
+                return i;
+            }
+            if (pow(ph / i) == one) {
+                ans = ph / i;
+            }
+        }
+    }
+    return ans;
+}
+
+DynResidue DynResidue::getPrimitiveRoot(const ModContext& context) {
+    uint32_t mod = context.modulus();
+    if (!has_primitive_root_helper(mod)) {
+        return DynResidue(0, context);
+    }
+    long long phim = phi(mod);
+    long long phim2 = phim;
+    std::vector<long long> fac;
+    for (long long i = 2; i * i <= phim2; ++i) {
+        if (phim2 % i == 0) {
+            while (phim2 % i == 0) {
+                phim2 /= i;
+            }
+            fac.push_back(i);
+        }
+    }
+    if (phim2 > 1) {
+        fac.push_back(phim2);
+    }
+    const DynResidue one(1, context);
+    for (long long i = 2;; ++i) {
+        DynResidue cur(i, context);
+        if (std::gcd(i, static_cast<long long>(mod)) != 1 || cur.pow(phim) != one) {
+            continue;
+        }
+        bool f = true;
+        for (long long j : fac) {
+            if (cur.pow(phim / j) == one) {
+                f = false;
+                break;
+            }
+        }
+        if (f) {
+            return cur;
+        }
+    }
+}
+
+void batchInverse(std::span<DynResidue> a) {
+    if (!a.empty()) {
+        prefixBatchInverse(a, DynResidue(0, a[0].context()), DynResidue(1, a[0].context()));
+    }
+}